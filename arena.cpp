@@ -0,0 +1,102 @@
+// --------------------------------------------------------- C++ System Headers
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+
+// ------------------------------------------------------------ Project Headers
+#include "arena.h"
+
+namespace {
+
+    const size_t FIRST_CHUNK_SIZE = 4096;
+    const size_t MAX_CHUNK_SIZE = 1 << 20;
+
+    thread_local std::shared_ptr<Arena> t_current;
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class Arena                                                               //
+///////////////////////////////////////////////////////////////////////////////
+
+Arena::Arena() :
+    m_cursor(nullptr),
+    m_limit(nullptr),
+    m_allocations(0),
+    m_bytes(0),
+    m_reserved(0)
+{}
+
+Arena::~Arena()
+{
+    for(char * chunk : m_chunks)
+    {
+        ::operator delete(chunk);
+    }
+}
+
+// Forgets every allocation so that the arena can serve the next analysis,
+// only valid once nothing refers to its symbols anymore
+void Arena::reset()
+{
+    // the last chunk is the largest one and is kept for the next analysis
+    if(!m_chunks.empty())
+    {
+        for(size_t i=0; i+1<m_chunks.size(); ++i)
+        {
+            ::operator delete(m_chunks[i]);
+        }
+        m_chunks.erase(m_chunks.begin(), m_chunks.end() - 1);
+        m_cursor = m_chunks.back();
+        m_reserved = (size_t) (m_limit - m_cursor);
+    }
+    m_allocations = 0;
+    m_bytes = 0;
+    m_strings.clear();
+}
+
+const std::string & Arena::intern(const std::string & text)
+{
+    return *m_strings.insert(text).first;
+}
+
+const std::shared_ptr<Arena> & Arena::current()
+{
+    return t_current;
+}
+
+void * Arena::allocate_chunk(size_t size)
+{
+    // chunks grow geometrically so that large analyses need few of them
+    size_t chunk_size = FIRST_CHUNK_SIZE;
+    if(!m_chunks.empty())
+    {
+        chunk_size = std::min(2 * (size_t) (m_limit - m_chunks.back()), MAX_CHUNK_SIZE);
+    }
+    chunk_size = std::max(chunk_size, size);
+
+    char * chunk = (char *) ::operator new(chunk_size);
+    LR1_STATS_COUNT(chunks);
+    m_chunks.push_back(chunk);
+    m_reserved += chunk_size;
+    m_cursor = chunk + size;
+    m_limit = chunk + chunk_size;
+    return chunk;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class Arena::Scope                                                        //
+///////////////////////////////////////////////////////////////////////////////
+
+Arena::Scope::Scope(std::shared_ptr<Arena> arena) :
+    m_previous(std::move(t_current))
+{
+    t_current = std::move(arena);
+}
+
+Arena::Scope::~Scope()
+{
+    t_current = std::move(m_previous);
+}
@@ -0,0 +1,95 @@
+#ifndef ARENA_H_INCLUDED
+#define ARENA_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "stats.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class Arena                                                               //
+///////////////////////////////////////////////////////////////////////////////
+
+// Bump allocator the symbols of one analysis are carved from. Memory is only
+// released in bulk, when the last owner of the arena (the parser or the Axiom
+// it produced) drops it.
+class Arena
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    Arena();
+    Arena(const Arena & source) = delete;
+    ~Arena();
+
+    // ------------------------------------------------ Public Member Functions
+    inline void * allocate(size_t size);
+    const std::string & intern(const std::string & text);
+    inline size_t allocations() const { return m_allocations; }
+    inline size_t bytes() const { return m_bytes; }
+    inline size_t chunks() const { return m_chunks.size(); }
+    inline size_t reserved() const { return m_reserved; }
+    void reset();
+
+    // Arena used by Symbol::operator new on the calling thread, if any
+    static const std::shared_ptr<Arena> & current();
+
+    // --------------------------------------------------- Overloaded Operators
+    Arena & operator=(const Arena & source) = delete;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // class Arena::Scope                                                    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Makes an arena current on the calling thread for its lifetime
+    class Scope
+    {
+    public:
+        Scope(std::shared_ptr<Arena> arena);
+        Scope(const Scope & source) = delete;
+        ~Scope();
+
+        Scope & operator=(const Scope & source) = delete;
+
+    private:
+        std::shared_ptr<Arena> m_previous;
+    };
+
+private:
+    char * m_cursor;
+    char * m_limit;
+    size_t m_allocations;
+    size_t m_bytes;
+    size_t m_reserved; // Bytes of all chunks, used or not
+    std::vector<char *> m_chunks;
+    std::unordered_set<std::string> m_strings;
+
+    // ----------------------------------------------- Private Member Functions
+    void * allocate_chunk(size_t size);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline Member Functions                                                   //
+///////////////////////////////////////////////////////////////////////////////
+
+inline void * Arena::allocate(size_t size)
+{
+    size = (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+    ++m_allocations;
+    m_bytes += size;
+    LR1_STATS_COUNT(allocations);
+    LR1_STATS_ADD(allocated_bytes, size);
+    if((size_t) (m_limit - m_cursor) < size)
+    {
+        return allocate_chunk(size);
+    }
+    void * pointer = m_cursor;
+    m_cursor += size;
+    return pointer;
+}
+
+#endif // ARENA_H_INCLUDED
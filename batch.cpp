@@ -0,0 +1,300 @@
+// --------------------------------------------------------- C++ System Headers
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// ------------------------------------------------------------ Project Headers
+#include "batch.h"
+#include "cache.h"
+#include "fsm.h"
+#include "lexer.h"
+#include "stats.h"
+#include "symbols.h"
+#include "table.h"
+#include "threadpool.h"
+#include "trace.h"
+
+namespace {
+
+    const size_t OUTPUT_BUFFER_SIZE = 1 << 16;
+    const size_t WINDOW_SIZE = 1 << 20;   // Input bytes read per worker
+    const size_t CHUNKS_PER_THREAD = 8;   // Leaves room for work stealing
+
+    // Splits the next space-separated word off the front of text
+    std::string_view next_word(std::string_view & text)
+    {
+        size_t begin = text.find_first_not_of(' ');
+        if(begin == std::string_view::npos)
+        {
+            text = std::string_view();
+            return text;
+        }
+        size_t end = text.find(' ', begin);
+        if(end == std::string_view::npos)
+        {
+            end = text.size();
+        }
+        std::string_view word = text.substr(begin, end - begin);
+        text.remove_prefix(end);
+        return word;
+    }
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class BatchSolver                                                         //
+///////////////////////////////////////////////////////////////////////////////
+
+BatchSolver::BatchSolver(const std::map<std::string, double> & values, bool table, ParseCache * cache) :
+    m_table(table),
+    m_cache(cache),
+    m_fsm(Lexer(std::string_view())),
+    m_machine(Lexer(std::string_view())),
+    m_values(values)
+{}
+
+// Appends the value of the expression on the line, or an error message, and
+// a newline to output
+bool BatchSolver::solve(std::string_view line, std::string & output)
+{
+    if(!line.empty() && line.back() == '\r')
+    {
+        line.remove_suffix(1);
+    }
+    size_t separator = line.find(';');
+    std::string_view expression = line.substr(0, separator);
+
+    // the cached expression, if any, keeps axiom alive
+    std::shared_ptr<const CachedExpression> cached;
+    std::unique_ptr<const Axiom> parsed;
+    const Axiom * axiom;
+    if(m_cache != nullptr)
+    {
+        cached = m_cache->find(expression);
+        axiom = cached ? cached->axiom.get() : nullptr;
+    }
+    else
+    {
+        parsed = analyze(expression);
+        axiom = parsed.get();
+    }
+    if(axiom == nullptr)
+    {
+        output += "Invalid arithmetic expression!\n";
+        return false;
+    }
+    if(separator != std::string_view::npos && !bind(line.substr(separator + 1)))
+    {
+        unbind();
+        output += "Invalid variable binding!\n";
+        return false;
+    }
+
+    double value;
+    try
+    {
+        LR1_STATS_TIME(EVAL);
+        value = cached && cached->program ? cached->program->eval(m_values) : axiom->eval(m_values);
+    }
+    catch(const std::out_of_range &)
+    {
+        unbind();
+        output += "Unbound variable!\n";
+        return false;
+    }
+    unbind();
+
+    char buffer[32];
+    char * end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+    output.append(buffer, end - buffer);
+    output += '\n';
+    return true;
+}
+
+// Solves every line of input, returns the number of lines read
+size_t BatchSolver::run(std::istream & input, std::ostream & output)
+{
+    size_t lines = 0;
+    std::string line;
+    std::string buffer;
+    buffer.reserve(OUTPUT_BUFFER_SIZE);
+    while(std::getline(input, line))
+    {
+        solve(line, buffer);
+        ++lines;
+        if(buffer.size() >= OUTPUT_BUFFER_SIZE)
+        {
+            output.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    output.write(buffer.data(), buffer.size());
+    output.flush();
+    return lines;
+}
+
+// Solves every line of text, returns the number of lines solved
+size_t BatchSolver::solve_lines(std::string_view text, std::string & output)
+{
+    TraceSpan span("solve_lines");
+    size_t lines = 0;
+    while(!text.empty())
+    {
+        size_t end = std::min(text.find('\n'), text.size());
+        solve(text.substr(0, end), output);
+        text.remove_prefix(std::min(end + 1, text.size()));
+        ++lines;
+    }
+    return lines;
+}
+
+std::unique_ptr<const Axiom> BatchSolver::analyze(std::string_view expression)
+{
+    if(m_table)
+    {
+        m_machine.reset(Lexer(expression));
+        return m_machine.analyze();
+    }
+    m_fsm.reset(Lexer(expression));
+    return m_fsm.analyze();
+}
+
+bool BatchSolver::bind(std::string_view bindings)
+{
+    while(true)
+    {
+        std::string_view name = next_word(bindings);
+        if(name.empty())
+        {
+            return true;
+        }
+        std::string_view text = next_word(bindings);
+        double value;
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        if(text.empty() || result.ec != std::errc() || result.ptr != text.data() + text.size())
+        {
+            std::cerr << "[Error] Invalid value '" << text << "' for variable '" << name << "'" << std::endl;
+            return false;
+        }
+
+        std::pair<Binding, bool> inserted = m_values.emplace(name, value);
+        if(inserted.second)
+        {
+            m_inserted.push_back(inserted.first);
+        }
+        else
+        {
+            m_overridden.emplace_back(inserted.first, inserted.first->second);
+            inserted.first->second = value;
+        }
+    }
+}
+
+// Restores the bindings given to the constructor
+void BatchSolver::unbind()
+{
+    for(auto overridden = m_overridden.rbegin(); overridden != m_overridden.rend(); ++overridden)
+    {
+        overridden->first->second = overridden->second;
+    }
+    for(Binding inserted : m_inserted)
+    {
+        m_values.erase(inserted);
+    }
+    m_overridden.clear();
+    m_inserted.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class ParallelBatchSolver                                                 //
+///////////////////////////////////////////////////////////////////////////////
+
+ParallelBatchSolver::ParallelBatchSolver(const std::map<std::string, double> & values, bool table, size_t threads, ParseCache * cache) :
+    m_pool(threads)
+{
+    for(size_t i=0; i<m_pool.size(); ++i)
+    {
+        m_solvers.push_back(std::make_unique<BatchSolver>(values, table, cache));
+    }
+}
+
+// Solves every line of text in parallel, returns the number of lines solved
+size_t ParallelBatchSolver::solve(std::string_view text, std::ostream & output)
+{
+    // cut text into chunks of about the same size, ending after a newline
+    size_t chunks = CHUNKS_PER_THREAD * m_pool.size();
+    size_t chunk_size = text.size() / chunks + 1;
+    m_outputs.resize(chunks);
+    m_lines.assign(chunks, 0);
+    for(std::string & chunk_output : m_outputs)
+    {
+        chunk_output.clear();
+    }
+    size_t begin = 0;
+    for(size_t i=0; i<chunks && begin<text.size(); ++i)
+    {
+        size_t end = text.find('\n', std::min(begin + chunk_size, text.size()) - 1);
+        end = end == std::string_view::npos ? text.size() : end + 1;
+        std::string_view chunk = text.substr(begin, end - begin);
+        m_pool.submit([this, i, chunk] {
+            m_lines[i] = m_solvers[m_pool.worker()]->solve_lines(chunk, m_outputs[i]);
+        });
+        begin = end;
+    }
+    m_pool.wait();
+
+    size_t lines = 0;
+    for(size_t i=0; i<chunks; ++i)
+    {
+        output.write(m_outputs[i].data(), m_outputs[i].size());
+        lines += m_lines[i];
+    }
+    output.flush();
+    return lines;
+}
+
+// Reads input one window at a time, each window ending after a newline,
+// returns the number of lines read
+size_t ParallelBatchSolver::run(std::istream & input, std::ostream & output)
+{
+    size_t lines = 0;
+    std::string window;
+    while(input)
+    {
+        // the partial line at the end of the previous window comes first
+        size_t kept = window.size();
+        window.resize(kept + WINDOW_SIZE * m_pool.size());
+        input.read(&window[kept], window.size() - kept);
+        window.resize(kept + input.gcount());
+
+        size_t end = window.size();
+        if(input)
+        {
+            end = window.rfind('\n') + 1;
+        }
+        lines += solve(std::string_view(window).substr(0, end), output);
+        window.erase(0, end);
+    }
+    return lines;
+}
+
+// Solves text one window at a time, each window ending after a newline,
+// returns the number of lines solved. Lexers point straight into text.
+size_t ParallelBatchSolver::run(std::string_view text, std::ostream & output)
+{
+    size_t lines = 0;
+    size_t window_size = WINDOW_SIZE * m_pool.size();
+    while(!text.empty())
+    {
+        size_t end = text.find('\n', std::min(window_size, text.size()) - 1);
+        end = end == std::string_view::npos ? text.size() : end + 1;
+        lines += solve(text.substr(0, end), output);
+        text.remove_prefix(end);
+    }
+    return lines;
+}
@@ -0,0 +1,93 @@
+#ifndef BATCH_H_INCLUDED
+#define BATCH_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "cache.h"
+#include "fsm.h"
+#include "symbols.h"
+#include "table.h"
+#include "threadpool.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class BatchSolver                                                         //
+///////////////////////////////////////////////////////////////////////////////
+
+// Solves one expression per line, written as
+//     ARITHMETIC_EXPRESSION [; VAR_NAME VAR_VALUE [VAR_NAME VAR_VALUE]*]
+// where the bindings of a line override the ones given to the constructor.
+// The parser, its stacks and its arena are reset rather than rebuilt between
+// lines, and results are appended to a caller-owned buffer. Given a
+// ParseCache, expressions already seen are not parsed again.
+class BatchSolver
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    BatchSolver(const std::map<std::string, double> & values, bool table = false, ParseCache * cache = nullptr);
+    BatchSolver(const BatchSolver & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    bool solve(std::string_view line, std::string & output);
+    size_t solve_lines(std::string_view text, std::string & output);
+    size_t run(std::istream & input, std::ostream & output);
+
+    // --------------------------------------------------- Overloaded Operators
+    BatchSolver & operator=(const BatchSolver & source) = delete;
+
+private:
+    typedef std::map<std::string, double>::iterator Binding;
+
+    bool m_table;
+    ParseCache * m_cache;
+    FiniteStateMachine m_fsm;
+    TableMachine m_machine;
+    std::map<std::string, double> m_values;
+    std::vector<std::pair<Binding, double>> m_overridden; // Values to restore
+    std::vector<Binding> m_inserted;                      // Names to erase
+
+    // ----------------------------------------------- Private Member Functions
+    std::unique_ptr<const Axiom> analyze(std::string_view expression);
+    bool bind(std::string_view bindings);
+    void unbind();
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class ParallelBatchSolver                                                 //
+///////////////////////////////////////////////////////////////////////////////
+
+// Splits the input into newline-aligned chunks solved on a ThreadPool, each
+// worker with its own BatchSolver, and writes the results in input order.
+// The workers share the ParseCache, if any.
+class ParallelBatchSolver
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    ParallelBatchSolver(const std::map<std::string, double> & values, bool table = false, size_t threads = 0, ParseCache * cache = nullptr);
+    ParallelBatchSolver(const ParallelBatchSolver & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    size_t solve(std::string_view text, std::ostream & output);
+    size_t run(std::istream & input, std::ostream & output);
+    size_t run(std::string_view text, std::ostream & output);
+    inline size_t threads() const { return m_pool.size(); }
+
+    // --------------------------------------------------- Overloaded Operators
+    ParallelBatchSolver & operator=(const ParallelBatchSolver & source) = delete;
+
+private:
+    ThreadPool m_pool;
+    std::vector<std::unique_ptr<BatchSolver>> m_solvers; // One per worker
+    std::vector<std::string> m_outputs;                  // One per chunk
+    std::vector<size_t> m_lines;                         // One per chunk
+};
+
+#endif // BATCH_H_INCLUDED
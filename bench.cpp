@@ -0,0 +1,731 @@
+// --------------------------------------------------------- C++ System Headers
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "arena.h"
+#include "columnar.h"
+#include "fsm.h"
+#include "incremental.h"
+#include "lexer.h"
+#include "program.h"
+#include "reactive.h"
+#include "slots.h"
+#include "symbols.h"
+#include "table.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Allocation Counting                                                       //
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    size_t g_allocated_bytes = 0;
+
+}
+
+void * operator new(size_t size)
+{
+    g_allocated_bytes += size;
+    void * pointer = std::malloc(size == 0 ? 1 : size);
+    if(pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void * pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void * pointer, size_t size) noexcept
+{
+    (void) size;
+    std::free(pointer);
+}
+
+namespace {
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Workloads                                                             //
+    ///////////////////////////////////////////////////////////////////////////
+
+    const double MIN_SECONDS = 0.05;    // Minimal duration of a measure
+    const int REPETITIONS = 3;          // Measures per rate, the best is kept
+    const double TOLERANCE = 0.10;      // Default regression threshold
+    const size_t SIZES[] = { 64, 1024, 16384 };
+
+    // Each workload builds an expression of about `tokens` tokens
+    struct Workload
+    {
+        const char * name;
+        std::string (*build)(size_t tokens);
+    };
+
+    // a0+a1+a2+... over a few variables
+    std::string flat_sum(size_t tokens)
+    {
+        std::string text = "a0";
+        for(size_t i=2; i<tokens; i+=2)
+        {
+            text += "+a" + std::to_string(i/2 % 8);
+        }
+        return text;
+    }
+
+    // ((((...(a+1)...)))) with one level per three tokens
+    std::string deep_nesting(size_t tokens)
+    {
+        size_t depth = tokens / 3;
+        return std::string(depth, '(') + "a0+1" + std::string(depth, ')');
+    }
+
+    // a0*a1-a2/a3+... with a distinct variable per operand
+    std::string variable_heavy(size_t tokens)
+    {
+        const char OPERATORS[] = "*-/+";
+        std::string text = "v0";
+        for(size_t i=2; i<tokens; i+=2)
+        {
+            text += OPERATORS[i/2 % 4];
+            text += "v" + std::to_string(i/2);
+        }
+        return text;
+    }
+
+    // 1.5*2.25+3.125-... with decimal literals only
+    std::string number_heavy(size_t tokens)
+    {
+        const char OPERATORS[] = "*+-/";
+        std::string text = "1.5";
+        for(size_t i=2; i<tokens; i+=2)
+        {
+            text += OPERATORS[i/2 % 4];
+            text += std::to_string(i/2 % 1000) + "." + std::to_string(i % 97 + 1);
+        }
+        return text;
+    }
+
+    // long identifiers and literals separated by spaces
+    std::string long_text(size_t tokens)
+    {
+        std::string text = "alphanumericidentifier0";
+        for(size_t i=2; i<tokens; i+=2)
+        {
+            text += i/2 % 2 ? " + " : " * ";
+            if(i/2 % 3 == 0)
+            {
+                text += "3.14159265358979323846";
+            }
+            else
+            {
+                text += "averylongvariablename" + std::to_string(i/2 % 16);
+            }
+        }
+        return text;
+    }
+
+    const Workload WORKLOADS[] = {
+        { "flat_sum", flat_sum },
+        { "deep_nesting", deep_nesting },
+        { "variable_heavy", variable_heavy },
+        { "number_heavy", number_heavy },
+        { "long_text", long_text },
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Measures                                                              //
+    ///////////////////////////////////////////////////////////////////////////
+
+    struct Result
+    {
+        std::string workload;
+        size_t size;
+        size_t tokens;
+        double tokens_per_s;
+        double parses_per_s;
+        double table_parses_per_s;
+        double evals_per_s;
+        size_t bytes_per_parse;
+    };
+
+    // Calls run until MIN_SECONDS have elapsed, returns the best rate in
+    // calls per second out of REPETITIONS measures
+    template <typename Function>
+    double rate(Function run)
+    {
+        typedef std::chrono::steady_clock Clock;
+        double best = 0.0;
+        for(int repetition=0; repetition<REPETITIONS; ++repetition)
+        {
+            size_t calls = 0;
+            size_t batch = 1;
+            Clock::time_point start = Clock::now();
+            double elapsed = 0.0;
+            while(elapsed < MIN_SECONDS)
+            {
+                for(size_t i=0; i<batch; ++i)
+                {
+                    run();
+                }
+                calls += batch;
+                batch *= 2;
+                elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            }
+            best = std::max(best, calls / elapsed);
+        }
+        return best;
+    }
+
+    size_t lex(const std::string & text)
+    {
+        Arena::Scope scope(std::make_shared<Arena>());
+        Lexer lexer(text);
+        size_t tokens = 0;
+        while(true)
+        {
+            const Symbol * symbol = lexer.top();
+            if(symbol == nullptr || *symbol == SID::END_OF_STREAM)
+            {
+                return tokens;
+            }
+            lexer.pop();
+            ++tokens;
+        }
+    }
+
+    Result measure(const Workload & workload, size_t size)
+    {
+        Result result;
+        result.workload = workload.name;
+        result.size = size;
+        std::string text = workload.build(size);
+        result.tokens = lex(text);
+
+        result.tokens_per_s = result.tokens * rate([&text] { lex(text); });
+        result.parses_per_s = rate([&text] {
+            FiniteStateMachine fsm((Lexer(text)));
+            fsm.analyze();
+        });
+        result.table_parses_per_s = rate([&text] {
+            TableMachine machine((Lexer(text)));
+            machine.analyze();
+        });
+
+        size_t before = g_allocated_bytes;
+        std::unique_ptr<const Axiom> axiom;
+        {
+            FiniteStateMachine fsm((Lexer(text)));
+            axiom = fsm.analyze();
+        }
+        result.bytes_per_parse = g_allocated_bytes - before;
+        result.evals_per_s = 0.0;
+        if(axiom.get() == nullptr)
+        {
+            std::cerr << "[Error] Invalid " << workload.name << " workload" << std::endl;
+            return result;
+        }
+
+        const SlotTable & slots = axiom->slots();
+        std::vector<double> values(slots.size());
+        for(size_t i=0; i<values.size(); ++i)
+        {
+            values[i] = 1.0 + i;
+        }
+        volatile double sink = 0.0;
+        result.evals_per_s = rate([&] { sink = axiom->eval(values.data()); });
+        return result;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Reports                                                               //
+    ///////////////////////////////////////////////////////////////////////////
+
+    void print_table(const std::vector<Result> & results)
+    {
+        std::printf("%-16s %7s %7s %13s %12s %12s %12s %12s\n", "workload", "size", "tokens",
+                "tokens/s", "parses/s", "table/s", "evals/s", "bytes/parse");
+        for(const Result & r : results)
+        {
+            std::printf("%-16s %7zu %7zu %13.0f %12.0f %12.0f %12.0f %12zu\n", r.workload.c_str(), r.size,
+                    r.tokens, r.tokens_per_s, r.parses_per_s, r.table_parses_per_s, r.evals_per_s, r.bytes_per_parse);
+        }
+    }
+
+    // One object per line, which is also what read_json() expects
+    void print_json(const std::vector<Result> & results, std::ostream & output)
+    {
+        output << "[\n";
+        for(size_t i=0; i<results.size(); ++i)
+        {
+            const Result & r = results[i];
+            char line[512];
+            std::snprintf(line, sizeof(line), "{\"workload\": \"%s\", \"size\": %zu, \"tokens\": %zu, "
+                    "\"tokens_per_s\": %.0f, \"parses_per_s\": %.0f, \"table_parses_per_s\": %.0f, "
+                    "\"evals_per_s\": %.0f, \"bytes_per_parse\": %zu}%s\n", r.workload.c_str(), r.size,
+                    r.tokens, r.tokens_per_s, r.parses_per_s, r.table_parses_per_s, r.evals_per_s,
+                    r.bytes_per_parse, i + 1 < results.size() ? "," : "");
+            output << line;
+        }
+        output << "]" << std::endl;
+    }
+
+    double field(const std::string & line, const std::string & key)
+    {
+        size_t position = line.find("\"" + key + "\": ");
+        if(position == std::string::npos)
+        {
+            return 0.0;
+        }
+        return std::atof(line.c_str() + position + key.size() + 4);
+    }
+
+    std::vector<Result> read_json(std::istream & input)
+    {
+        std::vector<Result> results;
+        std::string line;
+        while(std::getline(input, line))
+        {
+            size_t begin = line.find("\"workload\": \"");
+            if(begin == std::string::npos)
+            {
+                continue;
+            }
+            begin += 13;
+            Result r;
+            r.workload = line.substr(begin, line.find('"', begin) - begin);
+            r.size = (size_t) field(line, "size");
+            r.tokens = (size_t) field(line, "tokens");
+            r.tokens_per_s = field(line, "tokens_per_s");
+            r.parses_per_s = field(line, "parses_per_s");
+            r.table_parses_per_s = field(line, "table_parses_per_s");
+            r.evals_per_s = field(line, "evals_per_s");
+            r.bytes_per_parse = (size_t) field(line, "bytes_per_parse");
+            results.push_back(r);
+        }
+        return results;
+    }
+
+    // Returns true if current is worse than baseline by more than tolerance
+    bool regressed(const Result & result, const char * metric, double baseline, double current, bool lower_is_better, double tolerance)
+    {
+        double change = baseline > 0.0 ? (current - baseline) / baseline : 0.0;
+        bool regression = lower_is_better ? change > tolerance : change < -tolerance;
+        if(regression)
+        {
+            std::fprintf(stderr, "[Regression] %s/%zu %s: %.0f -> %.0f (%+.1f%%)\n", result.workload.c_str(),
+                    result.size, metric, baseline, current, 100.0 * change);
+        }
+        return regression;
+    }
+
+    size_t compare(const std::vector<Result> & baseline, const std::vector<Result> & results, double tolerance)
+    {
+        size_t regressions = 0;
+        for(const Result & current : results)
+        {
+            for(const Result & old : baseline)
+            {
+                if(old.workload != current.workload || old.size != current.size)
+                {
+                    continue;
+                }
+                regressions += regressed(current, "tokens/s", old.tokens_per_s, current.tokens_per_s, false, tolerance);
+                regressions += regressed(current, "parses/s", old.parses_per_s, current.parses_per_s, false, tolerance);
+                regressions += regressed(current, "table/s", old.table_parses_per_s, current.table_parses_per_s, false, tolerance);
+                regressions += regressed(current, "evals/s", old.evals_per_s, current.evals_per_s, false, tolerance);
+                regressions += regressed(current, "bytes/parse", old.bytes_per_parse, current.bytes_per_parse, true, tolerance);
+            }
+        }
+        return regressions;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Component Checks                                                      //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // A component checked against the code it stands in for on seeded random
+    // formulas, and both timed on the same work
+    struct Check
+    {
+        const char * component;
+        const char * unit;          // What the rates count
+        size_t checks;
+        size_t mismatches;
+        double reference_per_s;
+        double component_per_s;
+    };
+
+    // Bit for bit, any NaN matching any NaN
+    bool same_value(double a, double b)
+    {
+        return std::memcmp(&a, &b, sizeof(double)) == 0 || (a != a && b != b);
+    }
+
+    // Formula of at most `depth` levels over v0...v<variables-1>
+    std::string random_formula(std::mt19937_64 & random, int depth, size_t variables)
+    {
+        if(depth == 0 || random() % 4 == 0)
+        {
+            if(random() % 2 == 0)
+            {
+                return "v" + std::to_string(random() % variables);
+            }
+            return std::to_string(random() % 9 + 1);
+        }
+        std::string text = random_formula(random, depth - 1, variables);
+        text += "+-*/"[random() % 4];
+        text += random_formula(random, depth - 1, variables);
+        if(random() % 3 == 0)
+        {
+            return "(" + text + ")";
+        }
+        return text;
+    }
+
+    std::unique_ptr<const Axiom> parse(const std::string & text)
+    {
+        FiniteStateMachine fsm((Lexer(text)));
+        return fsm.analyze();
+    }
+
+    // ColumnarEvaluator against a Program evaluated row by row
+    Check check_columnar()
+    {
+        const size_t FORMULAS = 32;
+        const size_t ROWS = 4096;
+        Check check = { "columnar", "rows", 0, 0, 0.0, 0.0 };
+        std::mt19937_64 random(5);
+        std::vector<std::vector<double>> columns(16, std::vector<double>(ROWS));
+        std::vector<const double *> pointers;
+        for(std::vector<double> & column : columns)
+        {
+            for(double & value : column)
+            {
+                value = (double) (random() % 2001) / 100.0 - 10.0;
+            }
+            pointers.push_back(column.data());
+        }
+
+        std::vector<std::unique_ptr<const Axiom>> axioms;
+        std::vector<std::unique_ptr<const Program>> programs;
+        std::vector<std::unique_ptr<ColumnarEvaluator>> evaluators;
+        std::vector<std::vector<const double *>> bound; // Columns of each slot
+        while(programs.size() < FORMULAS)
+        {
+            axioms.push_back(parse(random_formula(random, 7, columns.size())));
+            programs.push_back(std::make_unique<const Program>(*axioms.back()));
+            evaluators.push_back(std::make_unique<ColumnarEvaluator>(*programs.back()));
+            bound.emplace_back();
+            for(size_t slot=0; slot<programs.back()->slots().size(); ++slot)
+            {
+                size_t variable = std::strtoul(programs.back()->slots().name(slot).c_str() + 1, nullptr, 10);
+                bound.back().push_back(pointers[variable]);
+            }
+        }
+
+        std::vector<double> output(ROWS);
+        std::vector<double> row(columns.size());
+        auto rowwise = [&](size_t formula, size_t r) {
+            for(size_t slot=0; slot<bound[formula].size(); ++slot)
+            {
+                row[slot] = bound[formula][slot][r];
+            }
+            return programs[formula]->eval(row.data());
+        };
+        for(size_t formula=0; formula<FORMULAS; ++formula)
+        {
+            evaluators[formula]->eval(bound[formula].data(), output.data(), ROWS);
+            for(size_t r=0; r<ROWS; ++r)
+            {
+                ++check.checks;
+                check.mismatches += !same_value(output[r], rowwise(formula, r));
+            }
+        }
+
+        volatile double sink = 0.0;
+        check.reference_per_s = FORMULAS * ROWS * rate([&] {
+            for(size_t formula=0; formula<FORMULAS; ++formula)
+            {
+                for(size_t r=0; r<ROWS; ++r)
+                {
+                    sink = rowwise(formula, r);
+                }
+            }
+        });
+        check.component_per_s = FORMULAS * ROWS * rate([&] {
+            for(size_t formula=0; formula<FORMULAS; ++formula)
+            {
+                evaluators[formula]->eval(bound[formula].data(), output.data(), ROWS);
+            }
+        });
+        return check;
+    }
+
+    // ReactiveNetwork::update against evaluating every formula again
+    Check check_reactive()
+    {
+        const size_t FORMULAS = 1000;
+        const size_t VARIABLES = 100;
+        const size_t BURSTS = 300;
+        Check check = { "reactive", "updates", 0, 0, 0.0, 0.0 };
+        std::mt19937_64 random(15);
+        ReactiveNetwork network;
+        std::map<std::string, double> values;
+        for(size_t variable=0; variable<VARIABLES; ++variable)
+        {
+            values["v" + std::to_string(variable)] = 1.0 + variable;
+            network.set("v" + std::to_string(variable), 1.0 + variable);
+        }
+        network.update();
+        std::vector<std::unique_ptr<const Axiom>> axioms;
+        while(axioms.size() < FORMULAS)
+        {
+            axioms.push_back(parse(random_formula(random, 6, VARIABLES)));
+            network.add(*axioms.back());
+        }
+
+        // signed zeros included, which only 1/x tells apart
+        auto set_random = [&] {
+            std::string name = "v" + std::to_string(random() % VARIABLES);
+            double value = (double) (random() % 101) - 50.0;
+            if(random() % 8 == 0)
+            {
+                value = random() % 2 == 0 ? 0.0 : -0.0;
+            }
+            values[name] = value;
+            network.set(name, value);
+        };
+        for(size_t burst=0; burst<BURSTS; ++burst)
+        {
+            size_t sets = random() % 3 + 1;
+            for(size_t i=0; i<sets; ++i)
+            {
+                set_random();
+            }
+            network.update();
+            for(size_t formula=0; formula<FORMULAS; ++formula)
+            {
+                ++check.checks;
+                check.mismatches += !same_value(network.value(formula), axioms[formula]->eval(values));
+            }
+        }
+
+        volatile double sink = 0.0;
+        check.reference_per_s = rate([&] {
+            for(const std::unique_ptr<const Axiom> & axiom : axioms)
+            {
+                sink = axiom->eval(values);
+            }
+        });
+        check.component_per_s = rate([&] {
+            set_random();
+            network.update();
+        });
+        return check;
+    }
+
+    // Bracketed tree of 2^depth leaves over v0...v19, left leaves are digits
+    std::string balanced_formula(int depth, size_t & leaves)
+    {
+        if(depth == 0)
+        {
+            size_t leaf = leaves++;
+            return leaf % 2 == 0 ? std::to_string(leaf % 9 + 1) : "v" + std::to_string(leaf % 20);
+        }
+        std::string text = "(" + balanced_formula(depth - 1, leaves);
+        text += "+-*/"[depth % 4];
+        text += balanced_formula(depth - 1, leaves);
+        return text + ")";
+    }
+
+    // IncrementalParser::edit against parsing the edited text from scratch
+    Check check_incremental()
+    {
+        const size_t ROUNDS = 300;
+        const size_t EDITS = 30;
+        const char * FRAGMENTS[] = { "(", ")", "+", "*", "1", "v3", "(v1+2)", " ", "" };
+        Check check = { "incremental", "edits", 0, 0, 0.0, 0.0 };
+        std::mt19937_64 random(16);
+        std::map<std::string, double> values;
+        for(size_t variable=0; variable<20; ++variable)
+        {
+            values["v" + std::to_string(variable)] = 0.5 + variable;
+        }
+
+        // edits may glue digits to a name, making variables never set
+        auto value = [&values](const Axiom & axiom) {
+            try
+            {
+                return axiom.eval(values);
+            }
+            catch(const std::out_of_range &)
+            {
+                return -1.0;
+            }
+        };
+
+        // random edits leave the text invalid as often as not: the syntax
+        // errors both parsers report are not the point here
+        std::streambuf * errors = std::cerr.rdbuf(nullptr);
+        for(size_t round=0; round<ROUNDS; ++round)
+        {
+            IncrementalParser parser(random_formula(random, 8, 20));
+            for(size_t i=0; i<EDITS; ++i)
+            {
+                size_t offset = random() % (parser.text().size() + 1);
+                size_t length = std::min((size_t) (random() % 3), parser.text().size() - offset);
+                const Axiom * edited = parser.edit(offset, length, FRAGMENTS[random() % 9]);
+                std::unique_ptr<const Axiom> parsed = parse(parser.text());
+                ++check.checks;
+                if(edited == nullptr || parsed == nullptr)
+                {
+                    check.mismatches += (edited == nullptr) != (parsed == nullptr);
+                    continue;
+                }
+                check.mismatches += edited->text() != parsed->text() || !same_value(value(*edited), value(*parsed));
+            }
+        }
+        std::cerr.rdbuf(errors);
+        std::cerr.clear();
+
+        // one leaf of a large balanced formula, edited back and forth
+        size_t leaves = 0;
+        IncrementalParser parser(balanced_formula(14, leaves));
+        size_t offset = parser.text().find("(1", parser.text().size() / 2) + 1;
+        size_t edits = 0;
+        check.reference_per_s = rate([&] { parse(parser.text()); });
+        check.component_per_s = rate([&] { parser.edit(offset, 1, ++edits % 2 ? "2" : "1"); });
+        return check;
+    }
+
+    void print_checks(const std::vector<Check> & checks)
+    {
+        std::printf("%-12s %-8s %9s %11s %14s %14s %8s\n", "component", "unit", "checks", "mismatches",
+                "reference/s", "component/s", "speedup");
+        for(const Check & c : checks)
+        {
+            std::printf("%-12s %-8s %9zu %11zu %14.0f %14.0f %7.1fx\n", c.component, c.unit, c.checks,
+                    c.mismatches, c.reference_per_s, c.component_per_s, c.component_per_s / c.reference_per_s);
+        }
+    }
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmark program                                                         //
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char **argv)
+{
+    // Options
+    bool json = false;
+    const char * baseline = nullptr;
+    const char * filter = nullptr;
+    bool components = false;
+    double tolerance = TOLERANCE;
+    bool usage = false;
+    for(int i=1; i<argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--json") == 0)
+        {
+            json = true;
+        }
+        else if(std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+        {
+            baseline = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+        {
+            tolerance = std::atof(argv[++i]) / 100.0;
+        }
+        else if(std::strcmp(argv[i], "--workload") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--components") == 0)
+        {
+            components = true;
+        }
+        else
+        {
+            usage = true;
+        }
+    }
+    if(usage || (components && (json || baseline != nullptr || filter != nullptr)))
+    {
+        std::cout << "Usage: ./LR1Bench [--json] [--workload NAME] [--baseline FILE.json] [--tolerance PERCENT]" << std::endl;
+        std::cout << "       ./LR1Bench --components" << std::endl;
+        return -1;
+    }
+
+    if(components)
+    {
+        std::vector<Check> checks;
+        checks.push_back(check_columnar());
+        checks.push_back(check_reactive());
+        checks.push_back(check_incremental());
+        print_checks(checks);
+        size_t mismatches = 0;
+        for(const Check & check : checks)
+        {
+            mismatches += check.mismatches;
+        }
+        if(mismatches > 0)
+        {
+            std::cerr << "[Error] " << mismatches << " result(s) differ from the reference" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    std::vector<Result> results;
+    for(const Workload & workload : WORKLOADS)
+    {
+        if(filter != nullptr && std::strcmp(filter, workload.name) != 0)
+        {
+            continue;
+        }
+        for(size_t size : SIZES)
+        {
+            results.push_back(measure(workload, size));
+        }
+    }
+
+    if(json)
+    {
+        print_json(results, std::cout);
+    }
+    else
+    {
+        print_table(results);
+    }
+
+    if(baseline != nullptr)
+    {
+        std::ifstream file(baseline);
+        if(!file)
+        {
+            std::cerr << "[Error] Cannot open '" << baseline << "'" << std::endl;
+            return -1;
+        }
+        size_t regressions = compare(read_json(file), results, tolerance);
+        std::cerr << "[Info] " << regressions << " regression(s) beyond " << 100.0 * tolerance << "%" << std::endl;
+        return regressions == 0 ? 0 : 1;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+// --------------------------------------------------------- C++ System Headers
+#include <cctype>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// ------------------------------------------------------------ Project Headers
+#include "arena.h"
+#include "cache.h"
+#include "fsm.h"
+#include "lexer.h"
+#include "program.h"
+#include "symbols.h"
+#include "table.h"
+
+namespace {
+
+    // Bookkeeping of an entry besides its text, arena and code: the entry,
+    // its list node and its index slot
+    const size_t ENTRY_OVERHEAD = sizeof(CachedExpression) + 64;
+
+    bool is_word(char c)
+    {
+        return std::isalnum(c) || c == '.';
+    }
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class ParseCache                                                          //
+///////////////////////////////////////////////////////////////////////////////
+
+ParseCache::ParseCache(size_t capacity, bool table, bool compile) :
+    m_capacity(capacity),
+    m_table(table),
+    m_compile(compile),
+    m_bytes(0),
+    m_hits(0),
+    m_misses(0),
+    m_evictions(0)
+{}
+
+std::shared_ptr<const CachedExpression> ParseCache::find(std::string_view expression)
+{
+    std::string text = normalize(expression);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_index.find(text);
+        if(found != m_index.end())
+        {
+            m_recency.splice(m_recency.begin(), m_recency, found->second);
+            ++m_hits;
+            return *found->second;
+        }
+    }
+    ++m_misses;
+    std::shared_ptr<const CachedExpression> parsed = parse(std::move(text));
+    if(!parsed || parsed->bytes > m_capacity)
+    {
+        return parsed;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_index.find(parsed->text);
+    if(found != m_index.end())
+    {
+        // parsed meanwhile by another thread
+        m_recency.splice(m_recency.begin(), m_recency, found->second);
+        return *found->second;
+    }
+    m_recency.push_front(parsed);
+    m_index.emplace(parsed->text, m_recency.begin());
+    m_bytes += parsed->bytes;
+    while(m_bytes > m_capacity)
+    {
+        const CachedExpression & evicted = *m_recency.back();
+        m_bytes -= evicted.bytes;
+        m_index.erase(evicted.text);
+        m_recency.pop_back();
+        ++m_evictions;
+    }
+    return parsed;
+}
+
+size_t ParseCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_recency.size();
+}
+
+size_t ParseCache::bytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytes;
+}
+
+std::string ParseCache::normalize(std::string_view expression)
+{
+    std::string text;
+    text.reserve(expression.size());
+    bool space = false;
+    for(char c : expression)
+    {
+        if(c == ' ')
+        {
+            space = true;
+            continue;
+        }
+        if(space && !text.empty() && is_word(text.back()) && is_word(c))
+        {
+            text += ' ';
+        }
+        space = false;
+        text += c;
+    }
+    return text;
+}
+
+// Parses text with a parser of its own, so that the Axiom owns its arena
+std::shared_ptr<CachedExpression> ParseCache::parse(std::string text) const
+{
+    std::shared_ptr<CachedExpression> parsed = std::make_shared<CachedExpression>();
+    parsed->text = std::move(text);
+    size_t arena_bytes = 0;
+    if(m_table)
+    {
+        TableMachine machine(Lexer(parsed->text));
+        parsed->axiom = machine.analyze();
+        arena_bytes = machine.arena()->reserved();
+    }
+    else
+    {
+        FiniteStateMachine fsm(Lexer(parsed->text));
+        parsed->axiom = fsm.analyze();
+        arena_bytes = fsm.arena()->reserved();
+    }
+    if(!parsed->axiom)
+    {
+        return std::shared_ptr<CachedExpression>();
+    }
+
+    parsed->bytes = ENTRY_OVERHEAD + parsed->text.capacity() + arena_bytes;
+    if(m_compile)
+    {
+        parsed->program = std::make_unique<const Program>(*parsed->axiom);
+        parsed->bytes += sizeof(Program) + parsed->program->size() * sizeof(Instruction);
+        parsed->bytes += parsed->program->constants().size() * sizeof(double);
+    }
+    return parsed;
+}
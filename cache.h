@@ -0,0 +1,83 @@
+#ifndef CACHE_H_INCLUDED
+#define CACHE_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// ------------------------------------------------------------ Project Headers
+#include "program.h"
+#include "symbols.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// struct CachedExpression                                                   //
+///////////////////////////////////////////////////////////////////////////////
+
+// Shared by the cache and its users: an evicted expression stays alive until
+// the last user drops it
+struct CachedExpression
+{
+    std::string text;                       // Normalized
+    std::unique_ptr<const Axiom> axiom;
+    std::unique_ptr<const Program> program; // Only when compiling
+    size_t bytes;                           // Estimated footprint
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class ParseCache                                                          //
+///////////////////////////////////////////////////////////////////////////////
+
+// Thread-safe least recently used cache of parsed expressions, keyed by their
+// normalized text and bounded by the estimated bytes of the entries. Lookups
+// hold a single mutex; misses parse outside of it, so concurrent misses do
+// not wait for each other. Invalid expressions are not cached.
+class ParseCache
+{
+public:
+    static const size_t DEFAULT_CAPACITY = 64 << 20;
+
+    // ----------------------------------------------- Constructor / Destructor
+    ParseCache(size_t capacity = DEFAULT_CAPACITY, bool table = false, bool compile = false);
+    ParseCache(const ParseCache & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    // Null when expression is invalid
+    std::shared_ptr<const CachedExpression> find(std::string_view expression);
+    inline size_t hits() const { return m_hits; }
+    inline size_t misses() const { return m_misses; }
+    inline size_t evictions() const { return m_evictions; }
+    inline size_t capacity() const { return m_capacity; }
+    size_t size() const;
+    size_t bytes() const;
+
+    // Drops the spaces that do not separate two numbers or variables
+    static std::string normalize(std::string_view expression);
+
+    // --------------------------------------------------- Overloaded Operators
+    ParseCache & operator=(const ParseCache & source) = delete;
+
+private:
+    typedef std::list<std::shared_ptr<const CachedExpression>> Recency;
+
+    size_t m_capacity;
+    bool m_table;
+    bool m_compile;
+    mutable std::mutex m_mutex;
+    Recency m_recency; // Most recently used first
+    std::unordered_map<std::string_view, Recency::iterator> m_index; // Views of the cached texts
+    size_t m_bytes;
+    std::atomic<size_t> m_hits;
+    std::atomic<size_t> m_misses;
+    std::atomic<size_t> m_evictions;
+
+    // ----------------------------------------------- Private Member Functions
+    std::shared_ptr<CachedExpression> parse(std::string text) const;
+};
+
+#endif // CACHE_H_INCLUDED
@@ -0,0 +1,206 @@
+// --------------------------------------------------------- C++ System Headers
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// ----------------------------------------------------------- Platform Headers
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COLUMNAR_X86
+#endif
+
+// ------------------------------------------------------------ Project Headers
+#include "columnar.h"
+#include "program.h"
+#include "symbols.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Kernels                                                                   //
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    const size_t BLOCK_SIZE = 256;  // Rows processed per instruction
+
+    // output[i] = left[i] OP right[i], output may alias left or right
+    typedef void (*Kernel)(double * output, const double * left, const double * right, size_t n);
+
+    struct KernelSet
+    {
+        const char * name;
+        Kernel add;
+        Kernel sub;
+        Kernel mul;
+        Kernel div;
+    };
+
+    // ----------------------------------------------------------------- Scalar
+    template <int OP>
+    inline double apply(double left, double right)
+    {
+        switch(OP)
+        {
+            case SID::OP_ADD: return left + right;
+            case SID::OP_SUB: return left - right;
+            case SID::OP_MUL: return left * right;
+        }
+        return left / right;
+    }
+
+    template <int OP>
+    void scalar(double * output, const double * left, const double * right, size_t n)
+    {
+        for(size_t i=0; i<n; ++i)
+        {
+            output[i] = apply<OP>(left[i], right[i]);
+        }
+    }
+
+#ifdef COLUMNAR_X86
+    // ------------------------------------------------------------------- SSE2
+    template <int OP>
+    __attribute__((target("sse2")))
+    inline __m128d apply_sse2(__m128d left, __m128d right)
+    {
+        switch(OP)
+        {
+            case SID::OP_ADD: return _mm_add_pd(left, right);
+            case SID::OP_SUB: return _mm_sub_pd(left, right);
+            case SID::OP_MUL: return _mm_mul_pd(left, right);
+        }
+        return _mm_div_pd(left, right);
+    }
+
+    template <int OP>
+    __attribute__((target("sse2")))
+    void sse2(double * output, const double * left, const double * right, size_t n)
+    {
+        size_t i = 0;
+        for(; i+2<=n; i+=2)
+        {
+            __m128d result = apply_sse2<OP>(_mm_loadu_pd(left + i), _mm_loadu_pd(right + i));
+            _mm_storeu_pd(output + i, result);
+        }
+        scalar<OP>(output + i, left + i, right + i, n - i);
+    }
+
+    // ------------------------------------------------------------------- AVX2
+    template <int OP>
+    __attribute__((target("avx2")))
+    inline __m256d apply_avx2(__m256d left, __m256d right)
+    {
+        switch(OP)
+        {
+            case SID::OP_ADD: return _mm256_add_pd(left, right);
+            case SID::OP_SUB: return _mm256_sub_pd(left, right);
+            case SID::OP_MUL: return _mm256_mul_pd(left, right);
+        }
+        return _mm256_div_pd(left, right);
+    }
+
+    template <int OP>
+    __attribute__((target("avx2")))
+    void avx2(double * output, const double * left, const double * right, size_t n)
+    {
+        size_t i = 0;
+        for(; i+4<=n; i+=4)
+        {
+            __m256d result = apply_avx2<OP>(_mm256_loadu_pd(left + i), _mm256_loadu_pd(right + i));
+            _mm256_storeu_pd(output + i, result);
+        }
+        scalar<OP>(output + i, left + i, right + i, n - i);
+    }
+#endif
+
+    const KernelSet & kernels()
+    {
+        static const KernelSet SCALAR = {
+            "scalar",
+            scalar<SID::OP_ADD>, scalar<SID::OP_SUB>, scalar<SID::OP_MUL>, scalar<SID::OP_DIV>
+        };
+#ifdef COLUMNAR_X86
+        static const KernelSet SSE2 = {
+            "sse2",
+            sse2<SID::OP_ADD>, sse2<SID::OP_SUB>, sse2<SID::OP_MUL>, sse2<SID::OP_DIV>
+        };
+        static const KernelSet AVX2 = {
+            "avx2",
+            avx2<SID::OP_ADD>, avx2<SID::OP_SUB>, avx2<SID::OP_MUL>, avx2<SID::OP_DIV>
+        };
+        static const KernelSet & selected =
+            __builtin_cpu_supports("avx2") ? AVX2 :
+            __builtin_cpu_supports("sse2") ? SSE2 : SCALAR;
+        return selected;
+#else
+        return SCALAR;
+#endif
+    }
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class ColumnarEvaluator                                                   //
+///////////////////////////////////////////////////////////////////////////////
+
+ColumnarEvaluator::ColumnarEvaluator(const Program & program) :
+    m_program(program),
+    m_blocks(program.stack_size() * BLOCK_SIZE),
+    m_stack(program.stack_size())
+{}
+
+void ColumnarEvaluator::eval(const double * const * columns, double * output, size_t rows)
+{
+    const KernelSet & kernel = kernels();
+    const std::vector<Instruction> & code = m_program.code();
+    const std::vector<double> & constants = m_program.constants();
+    for(size_t first=0; first<rows; first+=BLOCK_SIZE)
+    {
+        size_t n = std::min(BLOCK_SIZE, rows - first);
+
+        // stack entries point either into a variable column or into the
+        // block owned by their stack level
+        size_t depth = 0;
+        for(size_t pc=0; pc<code.size(); ++pc)
+        {
+            const Instruction & instruction = code[pc];
+            switch(instruction.opcode)
+            {
+                case SID::NUM:
+                {
+                    double * block = m_blocks.data() + depth * BLOCK_SIZE;
+                    std::fill_n(block, n, constants[instruction.operand]);
+                    m_stack[depth++] = block;
+                    continue;
+                }
+                case SID::VAR:
+                    m_stack[depth++] = columns[instruction.operand] + first;
+                    continue;
+            }
+
+            // binary operators write to the output directly when last
+            --depth;
+            double * result = m_blocks.data() + (depth - 1) * BLOCK_SIZE;
+            if(pc + 1 == code.size())
+            {
+                result = output + first;
+            }
+            switch(instruction.opcode)
+            {
+                case SID::OP_ADD: kernel.add(result, m_stack[depth-1], m_stack[depth], n); break;
+                case SID::OP_SUB: kernel.sub(result, m_stack[depth-1], m_stack[depth], n); break;
+                case SID::OP_MUL: kernel.mul(result, m_stack[depth-1], m_stack[depth], n); break;
+                case SID::OP_DIV: kernel.div(result, m_stack[depth-1], m_stack[depth], n); break;
+            }
+            m_stack[depth-1] = result;
+        }
+        if(m_stack[0] != output + first)
+        {
+            std::memcpy(output + first, m_stack[0], n * sizeof(double));
+        }
+    }
+}
+
+const char * ColumnarEvaluator::instruction_set()
+{
+    return kernels().name;
+}
@@ -0,0 +1,38 @@
+#ifndef COLUMNAR_H_INCLUDED
+#define COLUMNAR_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "program.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class ColumnarEvaluator                                                   //
+///////////////////////////////////////////////////////////////////////////////
+
+// Evaluates one Program over many rows at once: every instruction processes a
+// block of rows, and the arithmetic kernels use the widest SIMD extension the
+// CPU supports (AVX2, SSE2 or scalar, selected at runtime).
+class ColumnarEvaluator
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    ColumnarEvaluator(const Program & program);
+    ColumnarEvaluator(const ColumnarEvaluator & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    // columns[slot] points to the `rows` values of the variable in `slot`
+    void eval(const double * const * columns, double * output, size_t rows);
+    static const char * instruction_set();
+
+    // --------------------------------------------------- Overloaded Operators
+    ColumnarEvaluator & operator=(const ColumnarEvaluator & source) = delete;
+
+private:
+    const Program & m_program;
+    std::vector<double> m_blocks;              // One block per stack level
+    std::vector<const double *> m_stack;
+};
+
+#endif // COLUMNAR_H_INCLUDED
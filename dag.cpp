@@ -0,0 +1,164 @@
+// --------------------------------------------------------- C++ System Headers
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "dag.h"
+#include "slots.h"
+#include "symbols.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class Builder : public ExpressionWalker                                   //
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    typedef ExpressionDag::Node Node;
+
+    // Structural key of a node, constants are compared bitwise so that 0 and
+    // -0 stay distinct
+    struct NodeKey
+    {
+        int opcode;
+        unsigned int left;
+        unsigned int right;
+        unsigned long long bits;
+
+        bool operator==(const NodeKey & other) const
+        {
+            return opcode == other.opcode && left == other.left
+                && right == other.right && bits == other.bits;
+        }
+    };
+
+    struct NodeKeyHash
+    {
+        size_t operator()(const NodeKey & key) const
+        {
+            size_t hash = std::hash<unsigned long long>()(key.bits);
+            hash = hash * 31 + key.opcode;
+            hash = hash * 31 + key.left;
+            return hash * 31 + key.right;
+        }
+    };
+
+    // Interns the nodes of a tree children first: the nodes of the operands
+    // of an operator are the topmost of a stack
+    class Builder : public ExpressionWalker
+    {
+    public:
+        Builder(std::vector<Node> & nodes, SlotTable & slots) :
+            m_nodes(nodes),
+            m_slots(slots),
+            m_tree_size(0)
+        {}
+
+        inline size_t tree_size() const { return m_tree_size; }
+
+        unsigned int build(const Expression & expression)
+        {
+            walk(expression);
+            unsigned int root = m_results.back();
+            m_results.pop_back();
+            return root;
+        }
+
+    protected:
+        virtual void leave(const AtomicExpression & expression) override
+        {
+            ++m_tree_size;
+            const AtomicValue & value = expression.atomic_value();
+            if(value == SID::NUM)
+            {
+                double number = ((const Number &) value).value();
+                NodeKey key = { SID::NUM, 0, 0, 0 };
+                std::memcpy(&key.bits, &number, sizeof(number));
+                m_results.push_back(intern(key, Node{SID::NUM, 0, 0, number}));
+            }
+            else
+            {
+                unsigned int slot = m_slots.slot(((const Variable &) value).name());
+                m_results.push_back(intern(NodeKey{SID::VAR, slot, 0, 0}, Node{SID::VAR, slot, 0, 0.0}));
+            }
+        }
+
+        virtual void leave(const BinaryExpression & expression) override
+        {
+            ++m_tree_size;
+            unsigned int right = m_results.back();
+            m_results.pop_back();
+            unsigned int left = m_results.back();
+            m_results.pop_back();
+            int opcode = expression.binary_operator();
+
+            // + and * are commutative in IEEE 754 arithmetic
+            if((opcode == SID::OP_ADD || opcode == SID::OP_MUL) && right < left)
+            {
+                std::swap(left, right);
+            }
+            m_results.push_back(intern(NodeKey{opcode, left, right, 0}, Node{opcode, left, right, 0.0}));
+        }
+
+    private:
+        std::vector<Node> & m_nodes;
+        SlotTable & m_slots;
+        std::unordered_map<NodeKey, unsigned int, NodeKeyHash> m_index;
+        size_t m_tree_size;
+        std::vector<unsigned int> m_results;
+
+        unsigned int intern(const NodeKey & key, const Node & node)
+        {
+            auto inserted = m_index.emplace(key, m_nodes.size());
+            if(inserted.second)
+            {
+                m_nodes.push_back(node);
+            }
+            return inserted.first->second;
+        }
+    };
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class ExpressionDag                                                       //
+///////////////////////////////////////////////////////////////////////////////
+
+ExpressionDag::ExpressionDag(const Axiom & axiom, const SlotTable & slots) :
+    m_slots(slots)
+{
+    Builder builder(m_nodes, m_slots);
+    m_root = builder.build(axiom.expression());
+    m_tree_size = builder.tree_size();
+}
+
+double ExpressionDag::eval(const std::map<std::string, double> & values) const
+{
+    return eval(m_slots.values(values).data());
+}
+
+double ExpressionDag::eval(const double * values) const
+{
+    ValueBuffer buffer(m_nodes.size());
+    double * results = buffer.data();
+
+    // children come first: one pass computes every node exactly once
+    for(size_t i=0; i<m_nodes.size(); ++i)
+    {
+        const Node & node = m_nodes[i];
+        switch(node.opcode)
+        {
+            case SID::NUM: results[i] = node.value; break;
+            case SID::VAR: results[i] = values[node.left]; break;
+            case SID::OP_ADD: results[i] = results[node.left] + results[node.right]; break;
+            case SID::OP_SUB: results[i] = results[node.left] - results[node.right]; break;
+            case SID::OP_MUL: results[i] = results[node.left] * results[node.right]; break;
+            case SID::OP_DIV: results[i] = results[node.left] / results[node.right]; break;
+        }
+    }
+    return results[m_root];
+}
@@ -0,0 +1,57 @@
+#ifndef DAG_H_INCLUDED
+#define DAG_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <map>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "slots.h"
+#include "symbols.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class ExpressionDag                                                       //
+///////////////////////////////////////////////////////////////////////////////
+
+// Hash-consed form of an Axiom: structurally identical subtrees (up to the
+// operand order of + and *) are merged into a single node, and each node is
+// evaluated once per evaluation however many times it is shared.
+class ExpressionDag
+{
+public:
+    // ---------------------------------------------------------- Public Types
+    // Nodes are stored children first. SID::NUM nodes hold `value`, SID::VAR
+    // nodes the slot in `left`, SID::OP_xxx nodes their operand nodes.
+    struct Node
+    {
+        int opcode;
+        unsigned int left;
+        unsigned int right;
+        double value;
+    };
+
+    // ----------------------------------------------- Constructor / Destructor
+    ExpressionDag(const Axiom & axiom, const SlotTable & slots = SlotTable());
+    ExpressionDag(const ExpressionDag & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    double eval(const std::map<std::string, double> & values) const;
+    double eval(const double * values) const;
+    inline const SlotTable & slots() const { return m_slots; }
+    inline const std::vector<Node> & nodes() const { return m_nodes; }
+    inline unsigned int root() const { return m_root; }
+    inline size_t size() const { return m_nodes.size(); }
+    inline size_t tree_size() const { return m_tree_size; }
+
+    // --------------------------------------------------- Overloaded Operators
+    ExpressionDag & operator=(const ExpressionDag & source) = delete;
+
+private:
+    std::vector<Node> m_nodes;
+    SlotTable m_slots;
+    unsigned int m_root;
+    size_t m_tree_size; // Atomic and binary nodes of the source tree
+};
+
+#endif // DAG_H_INCLUDED
@@ -0,0 +1,144 @@
+// --------------------------------------------------------- C++ System Headers
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "flat.h"
+#include "slots.h"
+#include "symbols.h"
+
+namespace {
+
+    const char OPERATORS[] = "+-*/"; // Indexed by SID::OP_xxx - SID::OP_ADD
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class FlatTree                                                            //
+///////////////////////////////////////////////////////////////////////////////
+
+FlatTree::FlatTree() :
+    m_depth(0),
+    m_stack_size(0)
+{}
+
+std::string FlatTree::text() const
+{
+    // nodes still to print, or characters when `first` is not 0
+    std::string text;
+    std::vector<std::pair<char, size_t>> pending;
+    if(!m_nodes.empty())
+    {
+        pending.emplace_back(0, root());
+    }
+    while(!pending.empty())
+    {
+        std::pair<char, size_t> next = pending.back();
+        pending.pop_back();
+        if(next.first != 0)
+        {
+            text += next.first;
+            continue;
+        }
+        const Node & node = m_nodes[next.second];
+        switch(node.kind)
+        {
+            case SID::NUM:
+                text += Number::format(m_constants[node.operand]);
+                break;
+            case SID::VAR:
+                text += m_slots.name(node.operand);
+                break;
+            case SID::OPEN_BRACKET:
+                pending.emplace_back(')', 0);
+                pending.emplace_back(0, next.second - 1);
+                text += '(';
+                break;
+            default:
+                pending.emplace_back(0, right_operand(next.second));
+                pending.emplace_back(OPERATORS[node.kind - SID::OP_ADD], 0);
+                pending.emplace_back(0, left_operand(next.second));
+                break;
+        }
+    }
+    return text;
+}
+
+double FlatTree::eval(const std::map<std::string, double> & values) const
+{
+    return eval(m_slots.values(values).data());
+}
+
+double FlatTree::eval(const double * values) const
+{
+    ValueBuffer buffer(m_stack_size);
+    double * stack = buffer.data();
+
+    // in post-order both operands of an operator are the topmost values
+    double * top = stack; // One past the topmost value
+    for(const Node & node : m_nodes)
+    {
+        switch(node.kind)
+        {
+            case SID::NUM: *top++ = m_constants[node.operand]; break;
+            case SID::VAR: *top++ = values[node.operand]; break;
+            case SID::OP_ADD: --top; top[-1] = top[-1] + top[0]; break;
+            case SID::OP_SUB: --top; top[-1] = top[-1] - top[0]; break;
+            case SID::OP_MUL: --top; top[-1] = top[-1] * top[0]; break;
+            case SID::OP_DIV: --top; top[-1] = top[-1] / top[0]; break;
+        }
+    }
+    return top[-1];
+}
+
+// Bytes of the nodes, the constants and the variable names
+size_t FlatTree::bytes() const
+{
+    size_t bytes = m_nodes.size() * sizeof(Node) + m_constants.size() * sizeof(double);
+    for(size_t slot=0; slot<m_slots.size(); ++slot)
+    {
+        bytes += m_slots.name(slot).size();
+    }
+    return bytes;
+}
+
+// Empties the tree, keeping its storage for the next analysis
+void FlatTree::clear()
+{
+    m_nodes.clear();
+    m_constants.clear();
+    m_slots = SlotTable();
+    m_depth = 0;
+    m_stack_size = 0;
+}
+
+size_t FlatTree::add_number(double value)
+{
+    m_constants.push_back(value);
+    m_nodes.push_back({ SID::NUM, (unsigned int) (m_constants.size() - 1) });
+    m_stack_size = std::max(m_stack_size, ++m_depth);
+    return m_nodes.size() - 1;
+}
+
+size_t FlatTree::add_variable(const std::string & name)
+{
+    m_nodes.push_back({ SID::VAR, (unsigned int) m_slots.slot(name) });
+    m_stack_size = std::max(m_stack_size, ++m_depth);
+    return m_nodes.size() - 1;
+}
+
+size_t FlatTree::add_operator(int kind, size_t left_operand)
+{
+    m_nodes.push_back({ (unsigned char) kind, (unsigned int) left_operand });
+    --m_depth;
+    return m_nodes.size() - 1;
+}
+
+size_t FlatTree::add_brackets()
+{
+    m_nodes.push_back({ SID::OPEN_BRACKET, 0 });
+    return m_nodes.size() - 1;
+}
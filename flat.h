@@ -0,0 +1,70 @@
+#ifndef FLAT_H_INCLUDED
+#define FLAT_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <map>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "slots.h"
+#include "symbols.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class FlatTree                                                            //
+///////////////////////////////////////////////////////////////////////////////
+
+// Syntax tree of an expression stored as a contiguous array of 8-byte nodes
+// in post-order, appended by TableMachine::analyze(FlatTree &) as it reduces:
+// no node is allocated on its own, and operators, brackets and variable names
+// are not kept as symbols.
+class FlatTree
+{
+public:
+    // ---------------------------------------------------------- Public Types
+    // Kinds reuse the symbol identifiers. SID::NUM nodes hold the index of
+    // their constant in `operand`, SID::VAR nodes their slot, SID::OP_xxx
+    // nodes their left operand. The right operand of an operator and the
+    // inner expression of a SID::OPEN_BRACKET node are the node just before.
+    struct Node
+    {
+        unsigned char kind;
+        unsigned int operand;
+    };
+
+    // ----------------------------------------------- Constructor / Destructor
+    FlatTree();
+    FlatTree(const FlatTree & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    std::string text() const;
+    double eval(const std::map<std::string, double> & values) const;
+    double eval(const double * values) const;
+    inline const SlotTable & slots() const { return m_slots; }
+    inline const std::vector<Node> & nodes() const { return m_nodes; }
+    inline const std::vector<double> & constants() const { return m_constants; }
+    inline size_t size() const { return m_nodes.size(); }
+    inline size_t root() const { return m_nodes.size() - 1; }
+    inline size_t left_operand(size_t node) const { return m_nodes[node].operand; }
+    inline size_t right_operand(size_t node) const { return node - 1; }
+    size_t bytes() const;
+    void clear();
+
+    // Appends a node whose operands are already in the tree, returns its index
+    size_t add_number(double value);
+    size_t add_variable(const std::string & name);
+    size_t add_operator(int kind, size_t left_operand);
+    size_t add_brackets();
+
+    // --------------------------------------------------- Overloaded Operators
+    FlatTree & operator=(const FlatTree & source) = delete;
+
+private:
+    std::vector<Node> m_nodes;
+    std::vector<double> m_constants;
+    SlotTable m_slots;
+    size_t m_depth;      // Values left on the stack by the nodes so far
+    size_t m_stack_size; // Deepest stack eval() needs
+};
+
+#endif // FLAT_H_INCLUDED
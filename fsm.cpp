@@ -8,7 +8,9 @@
 // ------------------------------------------------------------ Project Headers
 #include "fsm.h"
 #include "lexer.h"
+#include "stats.h"
 #include "symbols.h"
+#include "trace.h"
 
 #define UNUSED_PARAMETER(X) (void)(X) // Ignore "unused parameter" warnings
 
@@ -16,27 +18,96 @@
 // class FiniteStateMachine                                                  //
 ///////////////////////////////////////////////////////////////////////////////
 
-FiniteStateMachine::FiniteStateMachine(const Lexer & lexer) :
+// Symbols are carved from arena when given, from a new arena otherwise
+FiniteStateMachine::FiniteStateMachine(const Lexer & lexer, std::shared_ptr<Arena> arena) :
+    m_arena(std::move(arena)),
     m_lexer(lexer),
-    m_fatal_error(false)
+    m_fatal_error(false),
+    m_reduced(false)
 {}
 
 std::unique_ptr<const Axiom> FiniteStateMachine::analyze()
 {
-    m_states.push(std::make_unique<const State1>());
+    TraceSpan span("analyze");
+    if(resume() != ACCEPTED)
+    {
+        return std::unique_ptr<const Axiom>();
+    }
+    return axiom();
+}
+
+FiniteStateMachine::Status FiniteStateMachine::feed(std::string_view chunk)
+{
+    m_lexer.feed(chunk);
+    return resume();
+}
+
+FiniteStateMachine::Status FiniteStateMachine::finish()
+{
+    m_lexer.finish();
+    return resume();
+}
+
+// Hands over the Axiom of an ACCEPTED analysis
+std::unique_ptr<const Axiom> FiniteStateMachine::axiom()
+{
+    return std::unique_ptr<const Axiom>((const Axiom*) m_symbols.top().release());
+}
+
+// Prepares the machine for another analysis, reusing its stacks and, when no
+// Axiom produced by the previous analysis is alive anymore, its arena
+void FiniteStateMachine::reset(const Lexer & lexer)
+{
+    while(!m_symbols.empty())
+    {
+        m_symbols.pop();
+    }
+    while(!m_states.empty())
+    {
+        m_states.pop();
+    }
+    m_lexer = lexer;
+    m_fatal_error = false;
+    m_reduced = false;
+    if(m_arena.use_count() == 1)
+    {
+        m_arena->reset();
+    }
+    else
+    {
+        m_arena.reset();
+    }
+}
+
+// Runs the automaton until it accepts, fails or runs out of input
+FiniteStateMachine::Status FiniteStateMachine::resume()
+{
+    if(!m_arena)
+    {
+        m_arena = std::make_shared<Arena>();
+    }
+    Arena::Scope scope(m_arena);
+    LR1_STATS_TIME(PARSE);
+    if(m_states.empty())
+    {
+        m_states.push(std::make_unique<const State1>());
+    }
     while(!m_fatal_error)
     {
-        std::unique_ptr<const Symbol> next = std::move(m_lexer.top());
-        if(next.get() == nullptr)
+        // each transition performs at most one shift or reduce and returns
+        // here, the goto following a reduce is the next transition
+        const Symbol * next = m_reduced ? m_symbols.top().get() : m_lexer.top();
+        m_reduced = false;
+        if(next == nullptr)
         {
-            return std::unique_ptr<const Axiom>();
+            return m_lexer.starved() ? NEED_INPUT : REJECTED;
         }
-        if(m_states.top()->transition(*this, std::move(next)))
+        if(m_states.top()->transition(*this, *next))
         {
-            return std::unique_ptr<const Axiom>((const Axiom*) m_symbols.top().release());
+            return ACCEPTED;
         }
     }
-    return std::unique_ptr<const Axiom>();
+    return REJECTED;
 }
 
 std::unique_ptr<const Symbol> FiniteStateMachine::pop_symbol()
@@ -48,14 +119,18 @@ std::unique_ptr<const Symbol> FiniteStateMachine::pop_symbol()
 
 void FiniteStateMachine::shift(
         std::unique_ptr<const State> state,
-        std::unique_ptr<const Symbol> symbol)
+        const Symbol & symbol)
 {
-    if(symbol->terminal())
+    // reduced nonterminals are already on the symbols stack (see reduce),
+    // terminals and spliced expressions come from the lexer
+    if(m_symbols.empty() || m_symbols.top().get() != &symbol)
     {
-        m_lexer.pop();
+        m_symbols.push(m_lexer.pop());
+        LR1_STATS_COUNT(shifts);
     }
     m_states.push(std::move(state));
-    m_symbols.push(std::move(symbol));
+    LR1_STATS_MAX(max_states, m_states.size());
+    LR1_STATS_MAX(max_symbols, m_symbols.size());
 }
 
 void FiniteStateMachine::reduce(size_t n, std::unique_ptr<const Symbol> symbol)
@@ -64,18 +139,25 @@ void FiniteStateMachine::reduce(size_t n, std::unique_ptr<const Symbol> symbol)
     {
         m_states.pop();
     }
-    m_states.top()->transition(*this, std::move(symbol));
+    LR1_STATS_COUNT(reduces[Stats::production(*symbol)]);
+    m_symbols.push(std::move(symbol));
+    m_reduced = true;
 }
 
 void FiniteStateMachine::error(bool fatal_error)
 {
     std::cerr << "[Error] Unexpected token '" << m_lexer.top()->text();
     std::cerr << "' was discarded" << std::endl;
+    LR1_STATS_COUNT(errors);
     if(fatal_error)
     {
         std::cerr << "[Error] Fatal error: analysis terminated" << std::endl;
         m_fatal_error = true;
     }
+    else
+    {
+        LR1_STATS_COUNT(recoveries);
+    }
     m_lexer.pop();
 }
 
@@ -85,24 +167,24 @@ void FiniteStateMachine::error(bool fatal_error)
 
 bool State1::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
-    switch(*symbol)
+    switch(symbol)
     {
         case SID::EXP:
-            fsm.shift(std::make_unique<const State2>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State2>(), symbol);
             return false;
         case SID::OPEN_BRACKET:
-            fsm.shift(std::make_unique<const State7>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State7>(), symbol);
             return false;
         case SID::VAR:
-            fsm.shift(std::make_unique<const State6>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State6>(), symbol);
             return false;
         case SID::NUM:
-            fsm.shift(std::make_unique<const State5>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State5>(), symbol);
             return false;
         case SID::AXIOM:
-            fsm.shift(std::make_unique<const Accept>(), std::move(symbol));
+            fsm.shift(std::make_unique<const Accept>(), symbol);
             return true; // Success
     }
     fsm.error();
@@ -111,21 +193,21 @@ bool State1::transition(
 
 bool State2::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
-    switch(*symbol)
+    switch(symbol)
     {
         case SID::OP_ADD:
-            fsm.shift(std::make_unique<const State3>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State3>(), symbol);
             return false;
         case SID::OP_SUB:
-            fsm.shift(std::make_unique<const State11>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State11>(), symbol);
             return false;
         case SID::OP_MUL:
-            fsm.shift(std::make_unique<const State10>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State10>(), symbol);
             return false;
         case SID::OP_DIV:
-            fsm.shift(std::make_unique<const State12>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State12>(), symbol);
             return false;
         case SID::END_OF_STREAM:
         {
@@ -140,21 +222,21 @@ bool State2::transition(
 
 bool State3::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
-    switch(*symbol)
+    switch(symbol)
     {
         case SID::VAR:
-            fsm.shift(std::make_unique<const State6>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State6>(), symbol);
             return false;
         case SID::NUM:
-            fsm.shift(std::make_unique<const State5>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State5>(), symbol);
             return false;
         case SID::OPEN_BRACKET:
-            fsm.shift(std::make_unique<const State7>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State7>(), symbol);
             return false;
         case SID::EXP:
-            fsm.shift(std::make_unique<const State4>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State4>(), symbol);
             return false;
     }
     fsm.error();
@@ -163,15 +245,15 @@ bool State3::transition(
 
 bool State4::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
-    switch(*symbol)
+    switch(symbol)
     {
         case SID::OP_MUL:
-            fsm.shift(std::make_unique<const State10>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State10>(), symbol);
             return false;
         case SID::OP_DIV:
-            fsm.shift(std::make_unique<const State12>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State12>(), symbol);
             return false;
     }
     std::unique_ptr<const Expression> right((Expression*) fsm.pop_symbol().release());
@@ -183,7 +265,7 @@ bool State4::transition(
 
 bool State5::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
     UNUSED_PARAMETER(symbol);
     std::unique_ptr<const AtomicValue> num((AtomicValue*) fsm.pop_symbol().release());
@@ -193,7 +275,7 @@ bool State5::transition(
 
 bool State6::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
     UNUSED_PARAMETER(symbol);
     std::unique_ptr<const AtomicValue> var((AtomicValue*) fsm.pop_symbol().release());
@@ -203,21 +285,21 @@ bool State6::transition(
 
 bool State7::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
-    switch(*symbol)
+    switch(symbol)
     {
         case SID::VAR:
-            fsm.shift(std::make_unique<const State6>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State6>(), symbol);
             return false;
         case SID::NUM:
-            fsm.shift(std::make_unique<const State5>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State5>(), symbol);
             return false;
         case SID::OPEN_BRACKET:
-            fsm.shift(std::make_unique<const State7>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State7>(), symbol);
             return false;
         case SID::EXP:
-            fsm.shift(std::make_unique<const State8>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State8>(), symbol);
             return false;    
     }
     fsm.error();
@@ -226,24 +308,24 @@ bool State7::transition(
 
 bool State8::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
-    switch(*symbol)
+    switch(symbol)
     {
         case SID::OP_ADD:
-            fsm.shift(std::make_unique<const State3>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State3>(), symbol);
             return false;
         case SID::OP_SUB:
-            fsm.shift(std::make_unique<const State11>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State11>(), symbol);
             return false;
         case SID::OP_MUL:
-            fsm.shift(std::make_unique<const State10>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State10>(), symbol);
             return false;
         case SID::OP_DIV:
-            fsm.shift(std::make_unique<const State12>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State12>(), symbol);
             return false;
         case SID::CLOSED_BRACKET:
-            fsm.shift(std::make_unique<const State9>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State9>(), symbol);
             return false;
     }
     fsm.error();
@@ -252,7 +334,7 @@ bool State8::transition(
 
 bool State9::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
     UNUSED_PARAMETER(symbol);
     std::unique_ptr<const ClosedBracket> closed_bracket((ClosedBracket*) fsm.pop_symbol().release());
@@ -264,21 +346,21 @@ bool State9::transition(
 
 bool State10::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
-    switch(*symbol)
+    switch(symbol)
     {
         case SID::VAR:
-            fsm.shift(std::make_unique<const State6>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State6>(), symbol);
             return false;
         case SID::NUM:
-            fsm.shift(std::make_unique<const State5>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State5>(), symbol);
             return false;
         case SID::OPEN_BRACKET:
-            fsm.shift(std::make_unique<const State7>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State7>(), symbol);
             return false;
         case SID::EXP:
-            fsm.shift(std::make_unique<const State15>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State15>(), symbol);
             return false;
     }
     fsm.error();
@@ -287,21 +369,21 @@ bool State10::transition(
 
 bool State11::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
-    switch(*symbol)
+    switch(symbol)
     {
         case SID::VAR:
-            fsm.shift(std::make_unique<const State6>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State6>(), symbol);
             return false;
         case SID::NUM:
-            fsm.shift(std::make_unique<const State5>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State5>(), symbol);
             return false;
         case SID::OPEN_BRACKET:
-            fsm.shift(std::make_unique<const State7>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State7>(), symbol);
             return false;
         case SID::EXP:
-            fsm.shift(std::make_unique<const State14>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State14>(), symbol);
             return false;
     }
     fsm.error();
@@ -310,21 +392,21 @@ bool State11::transition(
 
 bool State12::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
-    switch(*symbol)
+    switch(symbol)
     {
         case SID::VAR:
-            fsm.shift(std::make_unique<const State6>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State6>(), symbol);
             return false;
         case SID::NUM:
-            fsm.shift(std::make_unique<const State5>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State5>(), symbol);
             return false;
         case SID::OPEN_BRACKET:
-            fsm.shift(std::make_unique<const State7>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State7>(), symbol);
             return false;
         case SID::EXP:
-            fsm.shift(std::make_unique<const State13>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State13>(), symbol);
             return false;
     }
     fsm.error();
@@ -333,7 +415,7 @@ bool State12::transition(
 
 bool State13::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
     UNUSED_PARAMETER(symbol);
     std::unique_ptr<const Expression> right((Expression*) fsm.pop_symbol().release());
@@ -345,15 +427,15 @@ bool State13::transition(
 
 bool State14::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
-    switch(*symbol)
+    switch(symbol)
     {
         case SID::OP_MUL:
-            fsm.shift(std::make_unique<const State10>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State10>(), symbol);
             return false;
         case SID::OP_DIV:
-            fsm.shift(std::make_unique<const State12>(), std::move(symbol));
+            fsm.shift(std::make_unique<const State12>(), symbol);
             return false;
     }
     std::unique_ptr<const Expression> right((Expression*) fsm.pop_symbol().release());
@@ -365,7 +447,7 @@ bool State14::transition(
 
 bool State15::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
     UNUSED_PARAMETER(symbol);
     std::unique_ptr<const Expression> right((Expression*) fsm.pop_symbol().release());
@@ -377,7 +459,7 @@ bool State15::transition(
 
 bool Accept::transition(
         FiniteStateMachine & fsm,
-        std::unique_ptr<const Symbol> symbol) const
+        const Symbol & symbol) const
 {
     UNUSED_PARAMETER(fsm);
     UNUSED_PARAMETER(symbol);
@@ -4,8 +4,11 @@
 // --------------------------------------------------------- C++ System Headers
 #include <memory>
 #include <stack>
+#include <string_view>
+#include <vector>
 
 // ------------------------------------------------------------ Project Headers
+#include "arena.h"
 #include "lexer.h"
 #include "symbols.h"
 
@@ -16,27 +19,47 @@ class State;
 // class FiniteStateMachine                                                  //
 ///////////////////////////////////////////////////////////////////////////////
 
+// analyze() parses the whole expression of its lexer at once. A machine
+// built over a Lexer with no text is driven by feed() and finish() instead:
+// it parses as far as the chunks received so far allow, keeps its stacks
+// between calls and hands the Axiom over through axiom() once ACCEPTED.
 class FiniteStateMachine
 {
 public:
+    enum Status {
+        NEED_INPUT,     // Waiting for the next chunk or for finish()
+        ACCEPTED,       // The Axiom is ready, see axiom()
+        REJECTED        // Syntax error
+    };
+
     // ----------------------------------------------- Constructor / Destructor
-    FiniteStateMachine(const Lexer & lexer);
+    FiniteStateMachine(const Lexer & lexer, std::shared_ptr<Arena> arena = std::shared_ptr<Arena>());
     FiniteStateMachine(const FiniteStateMachine & source) = delete;
 
     // ------------------------------------------------ Public Member Functions
     std::unique_ptr<const Axiom> analyze();
+    Status feed(std::string_view chunk);
+    Status finish();
+    std::unique_ptr<const Axiom> axiom();
+    void reset(const Lexer & lexer);
     std::unique_ptr<const Symbol> pop_symbol();
-    void shift(std::unique_ptr<const State> state, std::unique_ptr<const Symbol> symbol);
+    void shift(std::unique_ptr<const State> state, const Symbol & symbol);
     void reduce(size_t n, std::unique_ptr<const Symbol> symbol);
     void error(bool fatal_error = true);
+    inline const Arena * arena() const { return m_arena.get(); }
 
     // --------------------------------------------------- Overloaded Operators
     FiniteStateMachine & operator=(const FiniteStateMachine & source) = delete;
 private:
+    std::shared_ptr<Arena> m_arena; // Outlives the symbols carved from it
     Lexer m_lexer;
     bool m_fatal_error;
-    std::stack<std::unique_ptr<const State>> m_states;
-    std::stack<std::unique_ptr<const Symbol>> m_symbols;
+    bool m_reduced; // The nonterminal on top of m_symbols awaits its goto
+    std::stack<std::unique_ptr<const State>, std::vector<std::unique_ptr<const State>>> m_states;
+    std::stack<std::unique_ptr<const Symbol>, std::vector<std::unique_ptr<const Symbol>>> m_symbols;
+
+    // ----------------------------------------------- Private Member Functions
+    Status resume();
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -53,7 +76,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const = 0;
+            const Symbol & symbol) const = 0;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -70,7 +93,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -87,7 +110,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -104,7 +127,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -121,7 +144,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -138,7 +161,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -155,7 +178,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -172,7 +195,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -189,7 +212,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -206,7 +229,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -223,7 +246,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -240,7 +263,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -257,7 +280,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -274,7 +297,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -291,7 +314,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -308,7 +331,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -325,7 +348,7 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual bool transition(
             FiniteStateMachine & fsm,
-            std::unique_ptr<const Symbol> symbol) const override;
+            const Symbol & symbol) const override;
 };
 
 #endif // FSM_H_INCLUDED
@@ -0,0 +1,283 @@
+// --------------------------------------------------------- C++ System Headers
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+
+namespace {
+
+    ///////////////////////////////////////////////////////////////////////////
+    // struct Shape                                                          //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Parameters of the generated expressions
+    struct Shape
+    {
+        std::string kind;       // random, flat, nested or balanced
+        size_t depth;           // Tree depth (random, nested, balanced)
+        size_t width;           // Operands (flat)
+        std::string operators;  // Operator mix, repeat one to weight it
+        size_t variables;       // Distinct variable names, 0 for none
+        size_t variable_ratio;  // Percentage of leaves that are variables
+        size_t bracket_ratio;   // Percentage of bracketed subtrees (random)
+        std::string literals;   // int, decimal or long
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // class Generator                                                       //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Builds expressions from a 64-bit Mersenne Twister, whose output is fixed
+    // by the standard: a given seed gives the same corpus everywhere. Random
+    // draws are sequenced one statement at a time, since the evaluation order
+    // of operands is not.
+    class Generator
+    {
+    public:
+        Generator(const Shape & shape, unsigned long long seed) :
+            m_shape(shape),
+            m_random(seed)
+        {}
+
+        inline const std::set<size_t> & used() const { return m_used; }
+
+        std::string expression()
+        {
+            m_used.clear();
+            if(m_shape.kind == "flat")
+            {
+                std::string text = leaf();
+                for(size_t i=1; i<m_shape.width; ++i)
+                {
+                    text += binary_operator();
+                    text += leaf();
+                }
+                return text;
+            }
+            if(m_shape.kind == "nested")
+            {
+                std::string inner = leaf();
+                inner += binary_operator();
+                inner += leaf();
+                return std::string(m_shape.depth, '(') + inner + std::string(m_shape.depth, ')');
+            }
+            if(m_shape.kind == "balanced")
+            {
+                return balanced(m_shape.depth);
+            }
+            return random_tree(m_shape.depth);
+        }
+
+        // Nonzero value of a variable, the same for every expression
+        std::string value(size_t variable)
+        {
+            std::mt19937_64 random(variable * 2654435761ULL + 1);
+            std::string integer = std::to_string(random() % 1000 + 1);
+            return integer + "." + std::to_string(random() % 100);
+        }
+
+    private:
+        const Shape & m_shape;
+        std::mt19937_64 m_random;
+        std::set<size_t> m_used; // Variables of the last expression
+
+        size_t pick(size_t n)
+        {
+            return (size_t) (m_random() % n);
+        }
+
+        std::string binary_operator()
+        {
+            return std::string(1, m_shape.operators[pick(m_shape.operators.size())]);
+        }
+
+        std::string leaf()
+        {
+            if(m_shape.variables > 0 && pick(100) < m_shape.variable_ratio)
+            {
+                size_t variable = pick(m_shape.variables);
+                m_used.insert(variable);
+                return "v" + std::to_string(variable);
+            }
+            // literals never are 0, so that divisions stay finite
+            std::string integer = std::to_string(pick(999) + 1);
+            if(m_shape.literals == "decimal")
+            {
+                return integer + "." + std::to_string(pick(1000));
+            }
+            if(m_shape.literals == "long")
+            {
+                integer += std::to_string(pick(1000000));
+                return integer + "." + std::to_string(m_random() % 1000000000000ULL);
+            }
+            return integer;
+        }
+
+        std::string random_tree(size_t depth)
+        {
+            if(depth == 0 || pick(4) == 0)
+            {
+                return leaf();
+            }
+            std::string text = random_tree(depth - 1);
+            text += binary_operator();
+            text += random_tree(depth - 1);
+            if(pick(100) < m_shape.bracket_ratio)
+            {
+                return "(" + text + ")";
+            }
+            return text;
+        }
+
+        std::string balanced(size_t depth)
+        {
+            if(depth == 0)
+            {
+                return leaf();
+            }
+            std::string text = "(" + balanced(depth - 1);
+            text += binary_operator();
+            text += balanced(depth - 1);
+            return text + ")";
+        }
+    };
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Generator program                                                         //
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char **argv)
+{
+    // Options
+    Shape shape = { "random", 8, 16, "+-*/", 26, 50, 30, "int" };
+    unsigned long long seed = 1;
+    size_t count = 1000;
+    const char * output = nullptr;
+    const char * bindings = nullptr;
+    bool inline_bindings = false;
+    bool usage = false;
+    for(int i=1; i<argc; ++i)
+    {
+        bool value = i + 1 < argc;
+        if(std::strcmp(argv[i], "--shape") == 0 && value)
+        {
+            shape.kind = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--depth") == 0 && value)
+        {
+            shape.depth = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--width") == 0 && value)
+        {
+            shape.width = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--operators") == 0 && value)
+        {
+            shape.operators = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--variables") == 0 && value)
+        {
+            shape.variables = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--variable-ratio") == 0 && value)
+        {
+            shape.variable_ratio = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--bracket-ratio") == 0 && value)
+        {
+            shape.bracket_ratio = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--literals") == 0 && value)
+        {
+            shape.literals = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--seed") == 0 && value)
+        {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--count") == 0 && value)
+        {
+            count = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--output") == 0 && value)
+        {
+            output = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--bindings") == 0 && value)
+        {
+            bindings = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--inline") == 0)
+        {
+            inline_bindings = true;
+        }
+        else
+        {
+            usage = true;
+        }
+    }
+    bool known_shape = shape.kind == "random" || shape.kind == "flat" || shape.kind == "nested" || shape.kind == "balanced";
+    bool known_literals = shape.literals == "int" || shape.literals == "decimal" || shape.literals == "long";
+    if(usage || !known_shape || !known_literals || shape.operators.find_first_not_of("+-*/") != std::string::npos
+            || shape.operators.empty() || shape.width == 0)
+    {
+        std::cout << "Usage: ./LR1Gen [--shape random|flat|nested|balanced] [--depth N] [--width N]" << std::endl;
+        std::cout << "                [--operators MIX] [--variables N] [--variable-ratio PERCENT]" << std::endl;
+        std::cout << "                [--bracket-ratio PERCENT] [--literals int|decimal|long]" << std::endl;
+        std::cout << "                [--seed N] [--count N] [--output FILE] [--bindings FILE] [--inline]" << std::endl;
+        return -1;
+    }
+
+    std::ofstream file;
+    std::ostream * expressions = &std::cout;
+    if(output != nullptr)
+    {
+        file.open(output);
+        if(!file)
+        {
+            std::cerr << "[Error] Cannot open '" << output << "'" << std::endl;
+            return -1;
+        }
+        expressions = &file;
+    }
+
+    // one expression per line, in the format read by LR1ExprSolver --batch
+    Generator generator(shape, seed);
+    std::string line;
+    for(size_t i=0; i<count; ++i)
+    {
+        line = generator.expression();
+        if(inline_bindings && !generator.used().empty())
+        {
+            line += " ;";
+            for(size_t variable : generator.used())
+            {
+                line += " v" + std::to_string(variable) + " " + generator.value(variable);
+            }
+        }
+        line += '\n';
+        expressions->write(line.data(), line.size());
+    }
+
+    // VAR_NAME VAR_VALUE pairs to append to the solver command line
+    if(bindings != nullptr)
+    {
+        std::ofstream bindings_file(bindings);
+        if(!bindings_file)
+        {
+            std::cerr << "[Error] Cannot open '" << bindings << "'" << std::endl;
+            return -1;
+        }
+        for(size_t variable=0; variable<shape.variables; ++variable)
+        {
+            bindings_file << (variable ? " v" : "v") << variable << " " << generator.value(variable);
+        }
+        bindings_file << std::endl;
+    }
+    return 0;
+}
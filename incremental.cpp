@@ -0,0 +1,177 @@
+// --------------------------------------------------------- C++ System Headers
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "arena.h"
+#include "fsm.h"
+#include "incremental.h"
+#include "lexer.h"
+#include "symbols.h"
+
+namespace {
+
+    const size_t COMPACTION_RATIO = 4; // Arena growth allowed between full parses
+
+    ///////////////////////////////////////////////////////////////////////////
+    // class Collector : public ExpressionWalker                             //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Lists the bracketed expressions of a tree in the order of their opening
+    // brackets in the text, except the ones within spliced expressions
+    class Collector : public ExpressionWalker
+    {
+    public:
+        Collector(
+                std::vector<const Expression *> & groups,
+                const std::unordered_set<const Expression *> & spliced) :
+            m_groups(groups),
+            m_spliced(spliced)
+        {}
+
+    protected:
+        virtual bool enter(const BracketedExpression & expression) override
+        {
+            if(m_spliced.count(&expression) != 0)
+            {
+                return false;
+            }
+            m_groups.push_back(&expression);
+            return true;
+        }
+
+    private:
+        std::vector<const Expression *> & m_groups;
+        const std::unordered_set<const Expression *> & m_spliced;
+    };
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class IncrementalParser                                                   //
+///////////////////////////////////////////////////////////////////////////////
+
+IncrementalParser::IncrementalParser(const std::string & text) :
+    m_text(text),
+    m_parsed_bytes(0),
+    m_reused(0)
+{
+    parse(false);
+}
+
+// Replaces the length bytes at offset with replacement and returns the new
+// Axiom, null if the new text is invalid
+const Axiom * IncrementalParser::edit(size_t offset, size_t length, const std::string & replacement)
+{
+    m_text.replace(offset, length, replacement);
+
+    // groups touching the edited range are dropped, the ones behind it move
+    size_t kept = 0;
+    for(const Group & group : m_groups)
+    {
+        if(group.end <= offset)
+        {
+            m_groups[kept++] = group;
+        }
+        else if(group.begin >= offset + length)
+        {
+            size_t begin = group.begin - length + replacement.size();
+            size_t end = group.end - length + replacement.size();
+            m_groups[kept++] = Group{begin, end, group.expression};
+        }
+    }
+    m_groups.resize(kept);
+
+    parse(m_arena->bytes() <= COMPACTION_RATIO * m_parsed_bytes);
+    return m_axiom.get();
+}
+
+void IncrementalParser::parse(bool reuse)
+{
+    // a full parse starts a new arena, the previous trees go with the old one
+    if(!reuse)
+    {
+        m_axiom.reset();
+        m_groups.clear();
+        m_arena = std::make_shared<Arena>();
+    }
+
+    // only the outermost of nested groups need to be spliced
+    Lexer lexer(m_text);
+    std::vector<Group> spliced;
+    for(const Group & group : m_groups)
+    {
+        if(spliced.empty() || group.begin >= spliced.back().end)
+        {
+            lexer.splice(group.begin, group.end, *group.expression);
+            spliced.push_back(group);
+        }
+    }
+    m_reused = spliced.size();
+
+    // past trees stay in the arena: the groups of the new tree may refer to
+    // them, and the previous groups stay valid if the new text is not
+    FiniteStateMachine fsm(lexer, m_arena);
+    std::unique_ptr<const Axiom> axiom = fsm.analyze();
+    m_axiom = std::move(axiom);
+    if(m_axiom)
+    {
+        index(spliced);
+    }
+    if(!reuse)
+    {
+        m_parsed_bytes = m_arena->bytes();
+    }
+}
+
+// Pairs the bracketed expressions parsed anew with their place in the text,
+// the groups within spliced ones are already known
+void IncrementalParser::index(const std::vector<Group> & spliced)
+{
+    std::unordered_set<const Expression *> skipped;
+    for(const Group & group : spliced)
+    {
+        skipped.insert(group.expression);
+    }
+    std::vector<const Expression *> expressions;
+    Collector collector(expressions, skipped);
+    collector.walk(m_axiom->expression());
+
+    std::vector<Group> groups;
+    std::vector<size_t> open;
+    auto next_spliced = spliced.begin();
+    for(size_t i=0; i<m_text.size(); ++i)
+    {
+        if(next_spliced != spliced.end() && next_spliced->begin == i)
+        {
+            i = (next_spliced++)->end - 1;
+        }
+        else if(m_text[i] == '(')
+        {
+            open.push_back(groups.size());
+            groups.push_back(Group{i, 0, nullptr});
+        }
+        else if(m_text[i] == ')' && !open.empty())
+        {
+            groups[open.back()].end = i + 1;
+            open.pop_back();
+        }
+    }
+    if(groups.size() != expressions.size())
+    {
+        m_groups.clear();
+        return;
+    }
+    for(size_t i=0; i<groups.size(); ++i)
+    {
+        groups[i].expression = expressions[i];
+    }
+
+    std::vector<Group> merged(m_groups.size() + groups.size());
+    std::merge(m_groups.begin(), m_groups.end(), groups.begin(), groups.end(), merged.begin(),
+            [](const Group & a, const Group & b) { return a.begin < b.begin; });
+    m_groups.swap(merged);
+}
@@ -0,0 +1,60 @@
+#ifndef INCREMENTAL_H_INCLUDED
+#define INCREMENTAL_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <memory>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "arena.h"
+#include "symbols.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class IncrementalParser                                                   //
+///////////////////////////////////////////////////////////////////////////////
+
+// Keeps an expression parsed while its text is edited. A bracketed group
+// parses to the same subtree wherever it appears, so after an edit every
+// group lying outside the edited range is spliced back as a single EXP
+// symbol instead of being lexed and parsed again. All the trees share one
+// Arena, which is replaced by a full parse once it holds mostly nodes of
+// past trees.
+class IncrementalParser
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    IncrementalParser(const std::string & text);
+    IncrementalParser(const IncrementalParser & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    const Axiom * edit(size_t offset, size_t length, const std::string & replacement);
+    inline const std::string & text() const { return m_text; }
+    inline const Axiom * axiom() const { return m_axiom.get(); }
+    inline size_t reused() const { return m_reused; }
+
+    // --------------------------------------------------- Overloaded Operators
+    IncrementalParser & operator=(const IncrementalParser & source) = delete;
+
+private:
+    // Bracketed group spanning [begin, end) of the text
+    struct Group
+    {
+        size_t begin;
+        size_t end;
+        const Expression * expression;
+    };
+
+    std::string m_text;
+    std::shared_ptr<Arena> m_arena;
+    std::unique_ptr<const Axiom> m_axiom; // Null while the text is invalid
+    std::vector<Group> m_groups;          // Sorted by begin
+    size_t m_parsed_bytes;                // Arena size after the last full parse
+    size_t m_reused;                      // Groups spliced by the last parse
+
+    // ----------------------------------------------- Private Member Functions
+    void parse(bool reuse);
+    void index(const std::vector<Group> & spliced);
+};
+
+#endif // INCREMENTAL_H_INCLUDED
@@ -0,0 +1,309 @@
+// --------------------------------------------------------- C++ System Headers
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// ----------------------------------------------------------- Platform Headers
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#include <sys/mman.h>
+#include <unistd.h>
+#define JIT_X86_64
+#endif
+
+// ------------------------------------------------------------ Project Headers
+#include "jit.h"
+#include "program.h"
+#include "symbols.h"
+
+namespace {
+
+    std::atomic<bool> g_perf_map(false);
+
+#ifdef JIT_X86_64
+    std::atomic<size_t> g_functions(0); // Numbers the perf map symbols
+    const int REGISTERS = 14;           // xmm0...xmm13 hold the stack top
+    const int SCRATCH = 15;             // xmm15 stages spilled values
+    const size_t MAX_DISPLACEMENT = 1 << 30;
+
+    // SSE2 scalar double instructions, encoded F2 [REX] 0F opcode ModRM
+    const unsigned char MOVSD_LOAD = 0x10;
+    const unsigned char MOVSD_STORE = 0x11;
+    const unsigned char ADDSD = 0x58;
+    const unsigned char MULSD = 0x59;
+    const unsigned char SUBSD = 0x5C;
+    const unsigned char DIVSD = 0x5E;
+
+    // Where an SSE2 operand lives
+    enum Base {
+        XMM,                            // Register xmm`value`
+        VALUES,                         // [rdi + value], the slot values
+        FRAME,                          // [rsp + value], the spilled stack
+        CONSTANTS                       // Constant `value`, RIP-relative
+    };
+
+    struct Operand
+    {
+        Base base;
+        size_t value;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // class Assembler                                                       //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Encodes the few x86-64 instructions a Program lowers to, constants are
+    // appended after the code and addressed relative to the instruction
+    // pointer
+    class Assembler
+    {
+    public:
+        Assembler() = default;
+
+        inline const std::vector<unsigned char> & code() const { return m_code; }
+
+        void sse(unsigned char opcode, int xmm, Operand operand)
+        {
+            byte(0xF2);
+            unsigned char rex = 0x40;
+            if(xmm >= 8)
+            {
+                rex |= 0x04;            // REX.R extends ModRM.reg
+            }
+            if(operand.base == XMM && operand.value >= 8)
+            {
+                rex |= 0x01;            // REX.B extends ModRM.rm
+            }
+            if(rex != 0x40)
+            {
+                byte(rex);
+            }
+            byte(0x0F);
+            byte(opcode);
+            unsigned char reg = (unsigned char) ((xmm & 7) << 3);
+            switch(operand.base)
+            {
+                case XMM:
+                    byte(0xC0 | reg | (operand.value & 7));
+                    break;
+                case VALUES:
+                    byte(0x80 | reg | 7);   // [rdi + disp32]
+                    dword((uint32_t) operand.value);
+                    break;
+                case FRAME:
+                    byte(0x80 | reg | 4);   // [rsp + disp32], SIB follows
+                    byte(0x24);
+                    dword((uint32_t) operand.value);
+                    break;
+                case CONSTANTS:
+                    byte(reg | 5);          // [rip + disp32], patched later
+                    m_patches.push_back(Patch{m_code.size(), operand.value});
+                    dword(0);
+                    break;
+            }
+        }
+
+        // sub rsp, size or add rsp, size
+        void frame(bool enter, size_t size)
+        {
+            byte(0x48);
+            byte(0x81);
+            byte(enter ? 0xEC : 0xC4);
+            dword((uint32_t) size);
+        }
+
+        void ret()
+        {
+            byte(0xC3);
+        }
+
+        // Appends the constants, 8-byte aligned, and resolves their addresses
+        void finish(const std::vector<double> & constants)
+        {
+            while(m_code.size() % 8 != 0)
+            {
+                byte(0xCC);
+            }
+            size_t table = m_code.size();
+            m_code.resize(table + constants.size() * sizeof(double));
+            std::memcpy(m_code.data() + table, constants.data(), constants.size() * sizeof(double));
+            for(const Patch & patch : m_patches)
+            {
+                int32_t displacement = (int32_t) (table + patch.constant * sizeof(double) - (patch.offset + 4));
+                std::memcpy(m_code.data() + patch.offset, &displacement, sizeof(displacement));
+            }
+        }
+
+    private:
+        struct Patch
+        {
+            size_t offset;              // Of the displacement in the code
+            size_t constant;
+        };
+
+        std::vector<unsigned char> m_code;
+        std::vector<Patch> m_patches;
+
+        void byte(unsigned int value)
+        {
+            m_code.push_back((unsigned char) value);
+        }
+
+        void dword(uint32_t value)
+        {
+            for(int i=0; i<4; ++i)
+            {
+                byte((value >> (8 * i)) & 0xFF);
+            }
+        }
+    };
+
+    // Stack level `depth` of the Program
+    Operand level(size_t depth)
+    {
+        if(depth < REGISTERS)
+        {
+            return Operand{XMM, depth};
+        }
+        return Operand{FRAME, (depth - REGISTERS) * sizeof(double)};
+    }
+
+    unsigned char arithmetic(int opcode)
+    {
+        switch(opcode)
+        {
+            case SID::OP_ADD: return ADDSD;
+            case SID::OP_SUB: return SUBSD;
+            case SID::OP_MUL: return MULSD;
+        }
+        return DIVSD;
+    }
+
+    // Lowers the postfix code, the System V ABI passes the values in rdi and
+    // expects the result in xmm0, which is stack level 0
+    void lower(const Program & program, Assembler & assembler)
+    {
+        size_t frame_size = 0;
+        if(program.stack_size() > REGISTERS)
+        {
+            // keeps rsp 16-byte aligned, although no call is ever made
+            frame_size = ((program.stack_size() - REGISTERS) * sizeof(double) + 15) & ~(size_t) 15;
+            assembler.frame(true, frame_size);
+        }
+        size_t depth = 0;
+        for(const Instruction & instruction : program.code())
+        {
+            if(instruction.opcode == SID::NUM || instruction.opcode == SID::VAR)
+            {
+                Operand source = instruction.opcode == SID::NUM
+                    ? Operand{CONSTANTS, instruction.operand}
+                    : Operand{VALUES, instruction.operand * sizeof(double)};
+                Operand target = level(depth++);
+                if(target.base == XMM)
+                {
+                    assembler.sse(MOVSD_LOAD, (int) target.value, source);
+                }
+                else
+                {
+                    assembler.sse(MOVSD_LOAD, SCRATCH, source);
+                    assembler.sse(MOVSD_STORE, SCRATCH, target);
+                }
+                continue;
+            }
+            Operand right = level(--depth);
+            Operand left = level(depth - 1);
+            if(left.base == XMM)
+            {
+                assembler.sse(arithmetic(instruction.opcode), (int) left.value, right);
+            }
+            else
+            {
+                assembler.sse(MOVSD_LOAD, SCRATCH, left);
+                assembler.sse(arithmetic(instruction.opcode), SCRATCH, right);
+                assembler.sse(MOVSD_STORE, SCRATCH, left);
+            }
+        }
+        if(frame_size > 0)
+        {
+            assembler.frame(false, frame_size);
+        }
+        assembler.ret();
+        assembler.finish(program.constants());
+    }
+
+    // One "START SIZE NAME" line per function, in hexadecimal
+    void write_perf_map(const void * function, size_t size)
+    {
+        std::ofstream map("/tmp/perf-" + std::to_string(::getpid()) + ".map", std::ios::app);
+        map << std::hex << (uintptr_t) function << " " << size << std::dec;
+        map << " lr1_jit_" << g_functions++ << std::endl;
+    }
+#endif
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class JitProgram                                                          //
+///////////////////////////////////////////////////////////////////////////////
+
+JitProgram::JitProgram(const Program & program) :
+    m_program(program),
+    m_function(nullptr),
+    m_memory(nullptr),
+    m_memory_size(0),
+    m_code_size(0)
+{
+#ifdef JIT_X86_64
+    // displacements are 32-bit: slots, spilled levels and constants must be
+    // within 2 GiB
+    if(program.slots().size() > MAX_DISPLACEMENT / sizeof(double)
+            || program.stack_size() > MAX_DISPLACEMENT / sizeof(double)
+            || program.size() > MAX_DISPLACEMENT / 32)
+    {
+        return;
+    }
+    Assembler assembler;
+    lower(program, assembler);
+    const std::vector<unsigned char> & code = assembler.code();
+
+    // the pages are written, then made executable and read-only
+    size_t page_size = (size_t) ::sysconf(_SC_PAGESIZE);
+    size_t memory_size = (code.size() + page_size - 1) / page_size * page_size;
+    void * memory = ::mmap(nullptr, memory_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(memory == MAP_FAILED)
+    {
+        return;
+    }
+    std::memcpy(memory, code.data(), code.size());
+    if(::mprotect(memory, memory_size, PROT_READ | PROT_EXEC) != 0)
+    {
+        ::munmap(memory, memory_size);
+        return;
+    }
+    m_memory = memory;
+    m_memory_size = memory_size;
+    m_code_size = code.size();
+    m_function = (Function) memory;
+    if(g_perf_map)
+    {
+        write_perf_map(memory, m_code_size);
+    }
+#endif
+}
+
+JitProgram::~JitProgram()
+{
+#ifdef JIT_X86_64
+    if(m_memory != nullptr)
+    {
+        ::munmap(m_memory, m_memory_size);
+    }
+#endif
+}
+
+void JitProgram::enable_perf_map()
+{
+    g_perf_map = true;
+}
@@ -0,0 +1,52 @@
+#ifndef JIT_H_INCLUDED
+#define JIT_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <cstddef>
+
+// ------------------------------------------------------------ Project Headers
+#include "program.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class JitProgram                                                          //
+///////////////////////////////////////////////////////////////////////////////
+
+// Native x86-64 code compiled from a Program: the postfix stack is mapped
+// onto SSE2 registers (spilled to the machine stack when deeper) and the
+// result is a plain function of the slot values. Elsewhere, or when no
+// executable memory can be mapped, function() is null and eval() interprets
+// the Program instead.
+class JitProgram
+{
+public:
+    typedef double (*Function)(const double * values);
+
+    // ----------------------------------------------- Constructor / Destructor
+    JitProgram(const Program & program);
+    JitProgram(const JitProgram & source) = delete;
+    ~JitProgram();
+
+    // ------------------------------------------------ Public Member Functions
+    inline Function function() const { return m_function; }
+    inline size_t code_size() const { return m_code_size; }
+    inline double eval(const double * values) const
+    {
+        return m_function != nullptr ? m_function(values) : m_program.eval(values);
+    }
+
+    // Lists the functions compiled from now on in /tmp/perf-PID.map, where
+    // perf looks for the symbols of JIT code
+    static void enable_perf_map();
+
+    // --------------------------------------------------- Overloaded Operators
+    JitProgram & operator=(const JitProgram & source) = delete;
+
+private:
+    const Program & m_program;
+    Function m_function;
+    void * m_memory;
+    size_t m_memory_size;
+    size_t m_code_size; // Code and constants
+};
+
+#endif // JIT_H_INCLUDED
@@ -1,72 +1,273 @@
 // --------------------------------------------------------- C++ System Headers
+#include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <cstring>
+#include <istream>
 #include <memory>
 #include <string>
+#include <string_view>
 
 // ------------------------------------------------------------ Project Headers
 #include "lexer.h"
+#include "stats.h"
 #include "symbols.h"
+#include "trace.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 // class Lexer                                                               //
 ///////////////////////////////////////////////////////////////////////////////
 
-Lexer::Lexer(const std::string & expression) :
-    m_expression(expression)
+Lexer::Lexer() :
+    m_offset(0),
+    m_lookahead_end(0),
+    m_lookahead_cached(false),
+    m_input(nullptr),
+    m_end_of_input(false),
+    m_next_splice(0)
+{}
+
+Lexer::Lexer(std::string_view expression) :
+    m_expression(expression),
+    m_offset(0),
+    m_lookahead_end(0),
+    m_lookahead_cached(false),
+    m_input(nullptr),
+    m_end_of_input(true),
+    m_next_splice(0)
 {
-    // remove leading and trailing whitespaces
-    size_t leading = m_expression.find_first_not_of(" ");
-    size_t trailing = m_expression.find_last_not_of(" ");
-    if(leading != std::string::npos)
+    TraceSpan span("Lexer");
+    // skip leading and trailing whitespaces
+    size_t leading = m_expression.find_first_not_of(' ');
+    size_t trailing = m_expression.find_last_not_of(' ');
+    if(leading != std::string_view::npos)
     {
-        m_expression = m_expression.substr(leading, trailing - leading + 1);
+        m_expression = m_expression.substr(0, trailing + 1);
+        m_offset = leading;
     }
     else
     {
-        m_expression.clear();
+        m_expression = std::string_view();
+    }
+}
+
+Lexer::Lexer(std::istream & input, size_t buffer_size) :
+    m_offset(0),
+    m_lookahead_end(0),
+    m_lookahead_cached(false),
+    m_input(&input),
+    m_buffer(std::max(buffer_size, (size_t) 1)),
+    m_end_of_input(false),
+    m_next_splice(0)
+{
+    TraceSpan span("Lexer");
+}
+
+Lexer::Lexer(const Lexer & source) :
+    m_expression(source.m_expression),
+    m_offset(source.m_offset),
+    m_lookahead_end(0),
+    m_lookahead_cached(false),
+    m_input(source.m_input),
+    m_buffer(source.m_buffer),
+    m_end_of_input(source.m_end_of_input),
+    m_splices(source.m_splices),
+    m_next_splice(source.m_next_splice)
+{
+    if(source.m_expression.data() == source.m_buffer.data())
+    {
+        m_expression = std::string_view(m_buffer.data(), m_expression.size());
     }
 }
 
-std::unique_ptr<const Symbol> Lexer::top() const
+Lexer & Lexer::operator=(const Lexer & source)
 {
-    return allocate_symbol(next_token());
+    m_offset = source.m_offset;
+    m_lookahead_end = 0;
+    m_lookahead_cached = false;
+    m_lookahead.reset();
+    m_input = source.m_input;
+    m_buffer = source.m_buffer;
+    m_end_of_input = source.m_end_of_input;
+    m_splices = source.m_splices;
+    m_next_splice = source.m_next_splice;
+    m_expression = source.m_expression;
+    if(source.m_expression.data() == source.m_buffer.data())
+    {
+        m_expression = std::string_view(m_buffer.data(), m_expression.size());
+    }
+    return *this;
+}
+
+const Symbol * Lexer::top()
+{
+    if(!m_lookahead_cached)
+    {
+        LR1_STATS_TIME(LEX);
+        if(!m_end_of_input && !buffer_token())
+        {
+            return nullptr;
+        }
+        while(m_next_splice < m_splices.size() && m_splices[m_next_splice].begin < m_offset)
+        {
+            ++m_next_splice;
+        }
+        if(m_next_splice < m_splices.size() && m_splices[m_next_splice].begin == m_offset)
+        {
+            const Splice & splice = m_splices[m_next_splice++];
+            m_lookahead = std::make_unique<const SharedExpression>(*splice.expression);
+            m_lookahead_end = splice.end;
+            m_lookahead_cached = true;
+            LR1_STATS_COUNT(tokens);
+            return m_lookahead.get();
+        }
+        std::string_view token = next_token();
+        m_lookahead = allocate_symbol(token);
+        m_lookahead_end = m_offset + token.size();
+        m_lookahead_cached = true;
+        LR1_STATS_COUNT(tokens);
+    }
+    return m_lookahead.get();
 }
 
 std::unique_ptr<const Symbol> Lexer::pop()
 {
-    std::string token = next_token();
-    m_expression.erase(0, token.size());
-    size_t whitespaces = m_expression.find_first_not_of(" ");
-    m_expression.erase(0, whitespaces);
-    return allocate_symbol(token);
+    top();
+    m_offset = m_lookahead_end;
+    while(m_offset < m_expression.size() && m_expression[m_offset] == ' ')
+    {
+        ++m_offset;
+    }
+    m_lookahead_cached = false;
+    return std::move(m_lookahead);
+}
+
+// Lexes the text in [begin, end), already parsed as expression, as a single
+// EXP symbol. Splices are given in text order and only apply to the
+// expression of a lexer built over a string_view.
+void Lexer::splice(size_t begin, size_t end, const Expression & expression)
+{
+    m_splices.push_back(Splice{begin, end, &expression});
 }
 
-std::string Lexer::next_token() const
+// Appends a chunk of the expression to a lexer built with no text
+void Lexer::feed(std::string_view chunk)
 {
-    if(m_expression.empty())
+    // only the unread bytes are kept, the cached lookahead ends among them
+    // the buffer has no storage yet before the first chunk, nor a chunk
+    // when it is empty: null pointers may not be passed to memmove/memcpy
+    size_t kept = m_expression.size() - m_offset;
+    if(kept > 0)
     {
-        return "";
+        std::memmove(m_buffer.data(), m_buffer.data() + m_offset, kept);
     }
-    char c = m_expression[0];
+    m_buffer.resize(kept + chunk.size());
+    if(!chunk.empty())
+    {
+        std::memcpy(m_buffer.data() + kept, chunk.data(), chunk.size());
+    }
+    if(m_lookahead_cached)
+    {
+        m_lookahead_end -= m_offset;
+    }
+    m_expression = std::string_view(m_buffer.data(), m_buffer.size());
+    m_offset = 0;
+}
 
-    // Variables & Numbers
-    if(std::isalnum(c))
+// Marks the end of the expression fed to a lexer built with no text
+void Lexer::finish()
+{
+    m_end_of_input = true;
+}
+
+// Makes sure the whole next token is in view, refilling the window from the
+// stream if any. False when a fed lexer needs another chunk first.
+bool Lexer::buffer_token()
+{
+    while(true)
     {
-        for(size_t i=1; i<m_expression.size(); ++i)
+        while(m_offset < m_expression.size() && m_expression[m_offset] == ' ')
         {
-            if(!(std::isalnum(m_expression[i]) || m_expression[i] == '.'))
+            ++m_offset;
+        }
+        if(m_end_of_input)
+        {
+            return true;
+        }
+        if(m_offset < m_expression.size())
+        {
+            // only numbers and variables may go on past the end of the view,
+            // and a carriage return may turn out to end the line
+            char c = m_expression[m_offset];
+            size_t end = m_offset + next_token().size();
+            if(end < m_expression.size() || (!std::isalnum(c) && c != '\r'))
             {
-                return m_expression.substr(0, i);
+                return true;
             }
         }
-        return m_expression;
+        if(m_input == nullptr)
+        {
+            return false;
+        }
+        refill();
+    }
+}
+
+// Moves the unread bytes to the front of the window and reads behind them,
+// the window only grows when a single token does not fit in it
+void Lexer::refill()
+{
+    size_t kept = m_expression.size() - m_offset;
+    std::memmove(m_buffer.data(), m_buffer.data() + m_offset, kept);
+    if(kept == m_buffer.size())
+    {
+        m_buffer.resize(2 * m_buffer.size());
+    }
+    m_input->read(m_buffer.data() + kept, m_buffer.size() - kept);
+    LR1_STATS_COUNT(refills);
+    size_t read = m_input->gcount();
+    const char * newline = (const char *) std::memchr(m_buffer.data() + kept, '\n', read);
+    if(newline != nullptr)
+    {
+        read = newline - (m_buffer.data() + kept);
+        m_end_of_input = true;
+        if(kept + read > 0 && m_buffer[kept + read - 1] == '\r')
+        {
+            --read;
+        }
+    }
+    if(!*m_input)
+    {
+        m_end_of_input = true;
+    }
+    m_expression = std::string_view(m_buffer.data(), kept + read);
+    m_offset = 0;
+}
+
+std::string_view Lexer::next_token() const
+{
+    if(m_offset >= m_expression.size())
+    {
+        return std::string_view();
+    }
+    char c = m_expression[m_offset];
+
+    // Variables & Numbers
+    if(std::isalnum(c))
+    {
+        size_t i = m_offset + 1;
+        while(i < m_expression.size() && (std::isalnum(m_expression[i]) || m_expression[i] == '.'))
+        {
+            ++i;
+        }
+        return m_expression.substr(m_offset, i - m_offset);
     }
 
     // Operators
-    return std::string(1, c);
+    return m_expression.substr(m_offset, 1);
 }
 
-std::unique_ptr<const Symbol> Lexer::allocate_symbol(const std::string & token) const
+std::unique_ptr<const Symbol> Lexer::allocate_symbol(std::string_view token) const
 {
     if(token.empty())
     {
@@ -77,11 +278,26 @@ std::unique_ptr<const Symbol> Lexer::allocate_symbol(const std::string & token)
     // Variables & Numbers
     if(std::isalpha(c))
     {
-        return std::make_unique<const Variable>(token);
+        return std::make_unique<const Variable>(std::string(token));
     }
     if(std::isdigit(c))
     {
-        return std::make_unique<const Number>(std::stod(token));
+        // std::from_chars only reads hexadecimal digits, such as the 1A or
+        // 1.8p1 of 0x1A and 0x1.8p1, when it is told so
+        std::string_view digits = token;
+        std::chars_format format = std::chars_format::general;
+        if(token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X'))
+        {
+            digits.remove_prefix(2);
+            format = std::chars_format::hex;
+        }
+        double value = 0.0;
+        std::from_chars_result result = std::from_chars(digits.data(), digits.data() + digits.size(), value, format);
+        if(result.ec != std::errc() || result.ptr != digits.data() + digits.size())
+        {
+            return std::unique_ptr<const Symbol>();
+        }
+        return std::make_unique<const Number>(value);
     }
 
     // Operators
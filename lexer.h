@@ -2,8 +2,10 @@
 #define LEXER_H_INCLUDED
 
 // --------------------------------------------------------- C++ System Headers
+#include <istream>
 #include <memory>
-#include <string>
+#include <string_view>
+#include <vector>
 
 // ------------------------------------------------------------ Project Headers
 #include "symbols.h"
@@ -12,22 +14,62 @@
 // class Lexer                                                               //
 ///////////////////////////////////////////////////////////////////////////////
 
+// Walks a cursor over a borrowed expression: the text is never copied and
+// must outlive the lexer (and its copies). The lookahead symbol is lexed once
+// and cached until it is popped.
+// A lexer built over a stream instead only holds a fixed-size window of the
+// expression, refilled as tokens are popped, so the text never needs to fit
+// in memory. The expression then ends at the first newline or at the end of
+// the stream, and copies share the stream: only one of them may be read.
+// A lexer built with no text is pushed its expression by feed() instead and
+// reports that it is starved() whenever the next token may continue in a
+// chunk yet to come, until finish() marks the end of the expression.
 class Lexer
 {
 public:
-    // ----------------------------------------------- Constructor
-    Lexer(const std::string & expression);
+    static const size_t DEFAULT_BUFFER_SIZE = 1 << 16;
+
+    // ----------------------------------------------- Constructor / Destructor
+    Lexer();
+    Lexer(std::string_view expression);
+    Lexer(std::istream & input, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    Lexer(const Lexer & source);
 
     // ------------------------------------------------ Public Member Functions
-    std::unique_ptr<const Symbol> top() const;
+    const Symbol * top();
     std::unique_ptr<const Symbol> pop();
+    void feed(std::string_view chunk);
+    void finish();
+    inline bool starved() const { return !m_lookahead_cached && !m_end_of_input; }
+    void splice(size_t begin, size_t end, const Expression & expression);
+
+    // --------------------------------------------------- Overloaded Operators
+    Lexer & operator=(const Lexer & source);
 
 private:
-    std::string m_expression;
-    
+    struct Splice
+    {
+        size_t begin;
+        size_t end;
+        const Expression * expression;
+    };
+
+    std::string_view m_expression;
+    size_t m_offset;
+    size_t m_lookahead_end;
+    bool m_lookahead_cached;
+    std::unique_ptr<const Symbol> m_lookahead;
+    std::istream * m_input;      // Null unless reading from a stream
+    std::vector<char> m_buffer;  // Window over m_input or the fed chunks
+    bool m_end_of_input;
+    std::vector<Splice> m_splices; // Sorted by begin
+    size_t m_next_splice;
+
     // ----------------------------------------------- Private Member Functions
-    std::string next_token() const;
-    std::unique_ptr<const Symbol> allocate_symbol(const std::string & token) const;
+    bool buffer_token();
+    void refill();
+    std::string_view next_token() const;
+    std::unique_ptr<const Symbol> allocate_symbol(std::string_view token) const;
 };
 
 #endif // LEXER_H_INCLUDED
@@ -1,12 +1,104 @@
 // --------------------------------------------------------- C++ System Headers
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <vector>
 
 // ------------------------------------------------------------ Project Headers
+#include "batch.h"
+#include "cache.h"
 #include "fsm.h"
+#include "dag.h"
+#include "flat.h"
+#include "jit.h"
 #include "lexer.h"
+#include "mapped.h"
+#include "optimizer.h"
+#include "program.h"
+#include "slots.h"
+#include "stats.h"
 #include "symbols.h"
+#include "table.h"
+#include "tiered.h"
+#include "trace.h"
+
+namespace {
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Helper Functions                                                      //
+    ///////////////////////////////////////////////////////////////////////////
+
+    void print_cache(const ParseCache * cache)
+    {
+        if(cache != nullptr)
+        {
+            std::cerr << "[Info] Parse cache: " << cache->hits() << " hits, " << cache->misses() << " misses, ";
+            std::cerr << cache->evictions() << " evictions, " << cache->size() << " entries (";
+            std::cerr << cache->bytes() << " bytes)" << std::endl;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // class StatsReport                                                     //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Prints the counters on stderr when main returns, once the objects
+    // declared after it (and the threads of a batch solver) are gone
+    class StatsReport
+    {
+    public:
+        StatsReport(bool enabled) :
+            m_enabled(enabled)
+        {}
+
+        StatsReport(const StatsReport & source) = delete;
+
+        ~StatsReport()
+        {
+            if(m_enabled)
+            {
+                Stats::total().print(std::cerr);
+            }
+        }
+
+        StatsReport & operator=(const StatsReport & source) = delete;
+
+    private:
+        bool m_enabled;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // class TraceReport                                                     //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Writes the trace when main returns, like StatsReport
+    class TraceReport
+    {
+    public:
+        TraceReport(std::ostream * output) :
+            m_output(output)
+        {}
+
+        TraceReport(const TraceReport & source) = delete;
+
+        ~TraceReport()
+        {
+            if(m_output != nullptr)
+            {
+                Tracer::write(*m_output);
+            }
+        }
+
+        TraceReport & operator=(const TraceReport & source) = delete;
+
+    private:
+        std::ostream * m_output;
+    };
+
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 // Driver program                                                            //
@@ -14,28 +106,321 @@
 
 int main(int argc, char **argv)
 {
-    if(argc < 2 || argc%2 != 0)
+    // Options
+    bool table = false;
+    bool compile = false;
+    bool jit = false;
+    bool dag = false;
+    bool flat = false;
+    size_t repeat = 0;
+    bool optimize = false;
+    bool fast_math = false;
+    bool batch = false;
+    bool map_file = false;
+    bool stream = false;
+    size_t threads = 1;
+    size_t cache_size = 0;
+    bool batch_options = false; // --threads or --cache
+    bool stats = false;
+    const char * trace = nullptr;
+    bool usage = false;
+    int first = 1;
+    for(; first < argc && std::strncmp(argv[first], "--", 2) == 0; ++first)
+    {
+        if(std::strcmp(argv[first], "--table") == 0)
+        {
+            table = true;
+        }
+        else if(std::strcmp(argv[first], "--compile") == 0)
+        {
+            compile = true;
+        }
+        else if(std::strcmp(argv[first], "--jit") == 0)
+        {
+            jit = true;
+        }
+        else if(std::strcmp(argv[first], "--perf-map") == 0)
+        {
+            jit = true;
+            JitProgram::enable_perf_map();
+        }
+        else if(std::strcmp(argv[first], "--dag") == 0)
+        {
+            dag = true;
+        }
+        else if(std::strcmp(argv[first], "--flat") == 0)
+        {
+            table = true;
+            flat = true;
+        }
+        else if(std::strcmp(argv[first], "--repeat") == 0 && first + 1 < argc)
+        {
+            repeat = std::strtoul(argv[++first], nullptr, 10);
+        }
+        else if(std::strcmp(argv[first], "--optimize") == 0)
+        {
+            optimize = true;
+        }
+        else if(std::strcmp(argv[first], "--fast-math") == 0)
+        {
+            optimize = true;
+            fast_math = true;
+        }
+        else if(std::strcmp(argv[first], "--batch") == 0)
+        {
+            batch = true;
+        }
+        else if(std::strcmp(argv[first], "--mmap") == 0)
+        {
+            batch = true;
+            map_file = true;
+        }
+        else if(std::strcmp(argv[first], "--stream") == 0)
+        {
+            stream = true;
+        }
+        else if(std::strcmp(argv[first], "--threads") == 0 && first + 1 < argc)
+        {
+            threads = std::strtoul(argv[++first], nullptr, 10);
+            batch_options = true;
+        }
+        else if(std::strcmp(argv[first], "--cache") == 0 && first + 1 < argc)
+        {
+            cache_size = std::strtoul(argv[++first], nullptr, 10) << 20;
+            batch_options = true;
+        }
+        else if(std::strcmp(argv[first], "--stats") == 0)
+        {
+            stats = true;
+        }
+        else if(std::strcmp(argv[first], "--trace") == 0 && first + 1 < argc)
+        {
+            trace = argv[++first];
+        }
+        else
+        {
+            usage = true;
+        }
+    }
+
+    // in batch and stream modes the input file is optional and defaults to
+    // stdin
+    int bindings = first + 1;
+    if(batch || stream)
     {
-        std::cout << "Usage: ./LR1 ARITHMETIC_EXPRESSION [VAR_NAME VAR_VALUE]*" << std::endl;
+        bindings = first + (argc - first)%2;
+    }
+    // each evaluation mode would silently override the ones after it, and
+    // the options a mode does not list in the usage would be ignored
+    int modes = (int) flat + (int) jit + (int) compile + (int) dag + (int) (repeat > 0);
+    if(usage || (!batch && !stream && argc - first < 1) || (argc - bindings)%2 != 0 || (map_file && bindings == first)
+            || modes > 1 || (batch && (stream || flat || jit || dag || repeat > 0 || optimize))
+            || (batch && compile && cache_size == 0) || (!batch && batch_options)
+            || (flat && (stream || optimize)) || (repeat > 0 && stream))
+    {
+        std::cout << "Usage: ./LR1 [--stats] [--trace FILE] [--table] [--compile | --jit | --perf-map | --dag | --repeat N] [--optimize] [--fast-math] ARITHMETIC_EXPRESSION [VAR_NAME VAR_VALUE]*" << std::endl;
+        std::cout << "       ./LR1 [--stats] [--trace FILE] --flat ARITHMETIC_EXPRESSION [VAR_NAME VAR_VALUE]*" << std::endl;
+        std::cout << "       ./LR1 [--stats] [--trace FILE] [--table] [--threads N] [--cache MIB [--compile]] --batch [FILE] [VAR_NAME VAR_VALUE]*" << std::endl;
+        std::cout << "       ./LR1 [--stats] [--trace FILE] [--table] [--threads N] [--cache MIB [--compile]] --mmap FILE [VAR_NAME VAR_VALUE]*" << std::endl;
+        std::cout << "       ./LR1 [--stats] [--trace FILE] [--table] [--compile | --jit | --perf-map | --dag] [--optimize] [--fast-math] --stream [FILE] [VAR_NAME VAR_VALUE]*" << std::endl;
         return -1;
     }
+#ifndef LR1_STATS
+    if(stats)
+    {
+        std::cerr << "[Error] --stats needs a build configured with -DLR1_STATS=ON" << std::endl;
+        return -1;
+    }
+#endif
+    StatsReport report(stats);
+
+    // in batch modes, --compile caches a Program next to each Axiom
+    std::unique_ptr<ParseCache> cache;
+    if(cache_size > 0)
+    {
+        cache = std::make_unique<ParseCache>(cache_size, table, compile);
+    }
+
+    std::ofstream trace_file;
+    if(trace != nullptr)
+    {
+        trace_file.open(trace);
+        if(!trace_file)
+        {
+            std::cerr << "[Error] Cannot open '" << trace << "'" << std::endl;
+            return -1;
+        }
+        Tracer::enable();
+    }
+    TraceReport trace_report(trace != nullptr ? &trace_file : nullptr);
 
     std::map<std::string, double> values;
-    for(int i=2; i<argc; i+=2)
+    for(int i=bindings; i<argc; i+=2)
     {
         values[argv[i]] = std::atof(argv[i+1]);
     }
 
-    Lexer lexer(argv[1]);
-    FiniteStateMachine fsm(lexer);
-    std::unique_ptr<const Axiom> a = fsm.analyze();
-    if(a.get() != nullptr)
+    if(map_file)
     {
-        std::cout << a->text() << " = " << a->eval(values) << std::endl;
+        std::ios::sync_with_stdio(false);
+        MappedFile mapped(argv[first]);
+        if(!mapped.is_open())
+        {
+            std::cerr << "[Error] Cannot map '" << argv[first] << "'" << std::endl;
+            return -1;
+        }
+        ParallelBatchSolver solver(values, table, threads, cache.get());
+        solver.run(mapped.text(), std::cout);
+        print_cache(cache.get());
+        return 0;
+    }
+
+    std::ifstream file;
+    std::istream * input = &std::cin;
+    if((batch || stream) && bindings != first && std::strcmp(argv[first], "-") != 0)
+    {
+        file.open(argv[first]);
+        if(!file)
+        {
+            std::cerr << "[Error] Cannot open '" << argv[first] << "'" << std::endl;
+            return -1;
+        }
+        input = &file;
+    }
+
+    if(batch)
+    {
+        std::ios::sync_with_stdio(false);
+        if(threads == 1)
+        {
+            BatchSolver solver(values, table, cache.get());
+            solver.run(*input, std::cout);
+        }
+        else
+        {
+            ParallelBatchSolver solver(values, table, threads, cache.get());
+            solver.run(*input, std::cout);
+        }
+        print_cache(cache.get());
+        return 0;
+    }
+
+    Lexer lexer = stream ? Lexer(*input) : Lexer(argv[first]);
+    std::unique_ptr<const Axiom> a;
+    if(table)
+    {
+        TableMachine machine(lexer);
+        a = machine.analyze();
     }
     else
+    {
+        FiniteStateMachine fsm(lexer);
+        a = fsm.analyze();
+    }
+    if(a.get() == nullptr)
     {
         std::cout << "Invalid arithmetic expression!" << std::endl;
+        return 0;
+    }
+
+    // the same text again, into the flat representation of the tree: the
+    // parsed tree is only kept to report its size next to the flat one, so
+    // --flat takes no option that would transform or evaluate it
+    FlatTree flat_tree;
+    if(flat)
+    {
+        TableMachine machine(lexer);
+        machine.analyze(flat_tree);
+        size_t nodes = flat_tree.size();
+        size_t tree_bytes = a->arena()->bytes();
+        std::cerr << "[Info] Flat tree of " << nodes << " nodes in " << flat_tree.bytes() << " bytes (";
+        std::cerr << (double) flat_tree.bytes() / nodes << " per node), parsed tree in " << tree_bytes;
+        std::cerr << " bytes (" << (double) tree_bytes / nodes << " per node)" << std::endl;
+    }
+
+    std::unique_ptr<const Axiom> optimized;
+    const Axiom * evaluated = a.get();
+    if(optimize)
+    {
+        Optimizer optimizer(fast_math);
+        optimized = optimizer.optimize(*a);
+        evaluated = optimized.get();
+        std::cerr << "[Info] Optimized " << optimizer.nodes_before() << " nodes into ";
+        std::cerr << optimizer.nodes_after() << " nodes";
+        if(!stream)
+        {
+            std::cerr << ": " << optimized->text();
+        }
+        std::cerr << std::endl;
+    }
+
+    // a streamed expression is likely too long to be worth walking as a tree
+    // on each evaluation: its Program runs in a single interpreter loop
+    if(stream && !dag)
+    {
+        compile = true;
+    }
+
+    double value = 0.0;
+    {
+        LR1_STATS_TIME(EVAL);
+        TraceSpan span("eval");
+        const SlotTable & slots = evaluated->slots();
+        std::vector<double> dense = slots.values(values);
+        if(flat)
+        {
+            value = flat_tree.eval(flat_tree.slots().values(values).data());
+        }
+        else if(jit)
+        {
+            Program program(*evaluated, slots);
+            JitProgram native(program);
+            if(native.function() != nullptr)
+            {
+                std::cerr << "[Info] Compiled " << program.size() << " instructions into ";
+                std::cerr << native.code_size() << " bytes of x86-64 code" << std::endl;
+            }
+            else
+            {
+                std::cerr << "[Info] No native code on this host, the Program is interpreted" << std::endl;
+            }
+            value = native.eval(dense.data());
+        }
+        else if(compile)
+        {
+            Program program(*evaluated, slots);
+            value = program.eval(dense.data());
+        }
+        else if(dag)
+        {
+            ExpressionDag expression_dag(*evaluated, slots);
+            std::cerr << "[Info] Merged " << expression_dag.tree_size() << " nodes into ";
+            std::cerr << expression_dag.size() << " DAG nodes" << std::endl;
+            value = expression_dag.eval(dense.data());
+        }
+        else if(repeat > 0)
+        {
+            TieredExecutor executor;
+            size_t expression = executor.add(*evaluated);
+            std::vector<double> tiered = executor.slots(expression).values(values);
+            for(size_t i=0; i<repeat; ++i)
+            {
+                value = executor.eval(expression, tiered.data());
+            }
+            std::cerr << "[Info] Evaluated " << repeat << " times, the last time by the ";
+            std::cerr << TieredExecutor::tier_name(executor.tier(expression)) << std::endl;
+        }
+        else
+        {
+            value = evaluated->eval(dense.data());
+        }
+    }
+
+    // a streamed expression is not echoed, its text may not fit in memory
+    if(!stream)
+    {
+        std::cout << (flat ? flat_tree.text() : a->text()) << " = ";
     }
+    std::cout << value << std::endl;
     return 0;
 }
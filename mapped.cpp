@@ -0,0 +1,85 @@
+// --------------------------------------------------------- C++ System Headers
+#include <cstddef>
+#include <string>
+
+// ----------------------------------------------------------- Platform Headers
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_POSIX
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+// ------------------------------------------------------------ Project Headers
+#include "mapped.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class MappedFile                                                          //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef MAPPED_POSIX
+MappedFile::MappedFile(const std::string & path) :
+    m_open(false),
+    m_data(nullptr),
+    m_size(0)
+{
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if(descriptor < 0)
+    {
+        return;
+    }
+    struct stat status;
+    if(::fstat(descriptor, &status) == 0)
+    {
+        m_size = (size_t) status.st_size;
+        m_open = true;
+        // empty files cannot be mapped, they are simply empty views
+        if(m_size > 0)
+        {
+            void * data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if(data == MAP_FAILED)
+            {
+                m_open = false;
+                m_size = 0;
+            }
+            else
+            {
+                ::madvise(data, m_size, MADV_SEQUENTIAL);
+                m_data = (const char *) data;
+            }
+        }
+    }
+    // the mapping stays valid once the descriptor is closed
+    ::close(descriptor);
+}
+
+MappedFile::~MappedFile()
+{
+    if(m_data != nullptr)
+    {
+        ::munmap((void *) m_data, m_size);
+    }
+}
+#else
+MappedFile::MappedFile(const std::string & path) :
+    m_open(false),
+    m_data(nullptr),
+    m_size(0)
+{
+    std::ifstream file(path, std::ios::binary);
+    if(file)
+    {
+        m_contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        m_open = true;
+        m_data = m_contents.data();
+        m_size = m_contents.size();
+    }
+}
+
+MappedFile::~MappedFile()
+{}
+#endif
@@ -0,0 +1,38 @@
+#ifndef MAPPED_H_INCLUDED
+#define MAPPED_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+///////////////////////////////////////////////////////////////////////////////
+// class MappedFile                                                          //
+///////////////////////////////////////////////////////////////////////////////
+
+// Read-only view of a whole file mapped in memory: lexers built over slices
+// of text() read the page cache directly and nothing is copied. Where mmap is
+// unavailable the file is read into a string instead.
+class MappedFile
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    MappedFile(const std::string & path);
+    MappedFile(const MappedFile & source) = delete;
+    ~MappedFile();
+
+    // ------------------------------------------------ Public Member Functions
+    inline bool is_open() const { return m_open; }
+    inline std::string_view text() const { return std::string_view(m_data, m_size); }
+
+    // --------------------------------------------------- Overloaded Operators
+    MappedFile & operator=(const MappedFile & source) = delete;
+
+private:
+    bool m_open;
+    const char * m_data;
+    size_t m_size;
+    std::string m_contents; // Only used without mmap
+};
+
+#endif // MAPPED_H_INCLUDED
@@ -0,0 +1,252 @@
+// --------------------------------------------------------- C++ System Headers
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "arena.h"
+#include "optimizer.h"
+#include "symbols.h"
+#include "trace.h"
+
+// --------------------------------------------------------------------- Macros
+#define UNUSED_PARAMETER(X) (void)(X) // Ignore "unused parameter" warnings
+
+namespace {
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Helper Functions                                                      //
+    ///////////////////////////////////////////////////////////////////////////
+
+    std::unique_ptr<const BinaryOperator> make_operator(int identifier)
+    {
+        switch(identifier)
+        {
+            case SID::OP_ADD: return std::make_unique<const AddOperator>();
+            case SID::OP_SUB: return std::make_unique<const SubOperator>();
+            case SID::OP_MUL: return std::make_unique<const MulOperator>();
+        }
+        return std::make_unique<const DivOperator>();
+    }
+
+    std::unique_ptr<const Expression> make_number(double value)
+    {
+        return std::make_unique<const AtomicExpression>(std::make_unique<const Number>(value));
+    }
+
+    bool is_number(const Expression & expression, double & value)
+    {
+        const AtomicExpression * atomic = dynamic_cast<const AtomicExpression *>(&expression);
+        if(atomic == nullptr || atomic->atomic_value() != SID::NUM)
+        {
+            return false;
+        }
+        value = ((const Number &) atomic->atomic_value()).value();
+        return true;
+    }
+
+    // True if x/value == x*(1/value) for every x, i.e. value is a power of 2
+    // whose reciprocal is a normal number
+    bool exact_reciprocal(double value)
+    {
+        int exponent;
+        double inverse = 1.0 / value;
+        return std::isnormal(value) && std::isnormal(inverse)
+            && std::fabs(std::frexp(value, &exponent)) == 0.5;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // class Counter : public ExpressionWalker                               //
+    ///////////////////////////////////////////////////////////////////////////
+
+    class Counter : public ExpressionWalker
+    {
+    public:
+        Counter() :
+            m_count(0)
+        {}
+
+        size_t count(const Expression & expression)
+        {
+            walk(expression);
+            return m_count;
+        }
+
+    protected:
+        virtual void leave(const AtomicExpression & expression) override
+        {
+            UNUSED_PARAMETER(expression);
+            ++m_count;
+        }
+
+        virtual bool enter(const BinaryExpression & expression) override
+        {
+            UNUSED_PARAMETER(expression);
+            ++m_count;
+            return true;
+        }
+
+        virtual bool enter(const BracketedExpression & expression) override
+        {
+            UNUSED_PARAMETER(expression);
+            ++m_count;
+            return true;
+        }
+
+    private:
+        size_t m_count;
+    };
+
+    size_t count(const Expression & expression)
+    {
+        Counter counter;
+        return counter.count(expression);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // class Rewriter : public ExpressionWalker                              //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Rewrites the tree bottom-up: the rewritten operands of an operator are
+    // the topmost of a stack of results, brackets are dropped
+    class Rewriter : public ExpressionWalker
+    {
+    public:
+        Rewriter(bool fast_math) :
+            m_fast_math(fast_math)
+        {}
+
+        std::unique_ptr<const Expression> rewrite(const Expression & expression)
+        {
+            walk(expression);
+            std::unique_ptr<const Expression> result = std::move(m_results.back());
+            m_results.pop_back();
+            return result;
+        }
+
+    protected:
+        virtual void leave(const AtomicExpression & expression) override
+        {
+            const AtomicValue & value = expression.atomic_value();
+            if(value == SID::NUM)
+            {
+                m_results.push_back(make_number(((const Number &) value).value()));
+            }
+            else
+            {
+                std::unique_ptr<const AtomicValue> variable = std::make_unique<const Variable>(((const Variable &) value).name());
+                m_results.push_back(std::make_unique<const AtomicExpression>(std::move(variable)));
+            }
+        }
+
+        virtual void leave(const BinaryExpression & expression) override
+        {
+            std::unique_ptr<const Expression> right = std::move(m_results.back());
+            m_results.pop_back();
+            std::unique_ptr<const Expression> left = std::move(m_results.back());
+            m_results.pop_back();
+            m_results.push_back(simplify(expression.binary_operator(), std::move(left), std::move(right)));
+        }
+
+    private:
+        bool m_fast_math;
+        std::vector<std::unique_ptr<const Expression>> m_results;
+
+        std::unique_ptr<const Expression> simplify(
+                const BinaryOperator & binary_operator,
+                std::unique_ptr<const Expression> left,
+                std::unique_ptr<const Expression> right)
+        {
+            double l = 0.0;
+            double r = 0.0;
+            bool left_constant = is_number(*left, l);
+            bool right_constant = is_number(*right, r);
+            if(left_constant && right_constant)
+            {
+                return make_number(binary_operator.eval(l, r));
+            }
+
+            // the grammar has no unary minus: x+(-c) is x-c and x-(-c) is x+c,
+            // exactly, and c prints back as a plain literal
+            if(right_constant && r < 0.0 && (binary_operator == SID::OP_ADD || binary_operator == SID::OP_SUB))
+            {
+                int opposite = binary_operator == SID::OP_ADD ? SID::OP_SUB : SID::OP_ADD;
+                return std::make_unique<const BinaryExpression>(std::move(left), make_number(-r), make_operator(opposite));
+            }
+            if(left_constant && l < 0.0 && binary_operator == SID::OP_ADD)
+            {
+                return std::make_unique<const BinaryExpression>(std::move(right), make_number(-l), make_operator(SID::OP_SUB));
+            }
+
+            switch(binary_operator)
+            {
+                case SID::OP_ADD:
+                    // x+(-0) is x, x+0 is not when x is -0
+                    if(right_constant && r == 0.0 && (std::signbit(r) || m_fast_math))
+                    {
+                        return left;
+                    }
+                    if(left_constant && l == 0.0 && (std::signbit(l) || m_fast_math))
+                    {
+                        return right;
+                    }
+                    break;
+                case SID::OP_SUB:
+                    // x-0 is x, x-(-0) is not when x is -0
+                    if(right_constant && r == 0.0 && (!std::signbit(r) || m_fast_math))
+                    {
+                        return left;
+                    }
+                    break;
+                case SID::OP_MUL:
+                    if(right_constant && r == 1.0)
+                    {
+                        return left;
+                    }
+                    if(left_constant && l == 1.0)
+                    {
+                        return right;
+                    }
+                    if(m_fast_math && ((right_constant && r == 0.0) || (left_constant && l == 0.0)))
+                    {
+                        return make_number(0.0);
+                    }
+                    break;
+                case SID::OP_DIV:
+                    if(right_constant && r == 1.0)
+                    {
+                        return left;
+                    }
+                    if(right_constant && (exact_reciprocal(r) || (m_fast_math && r != 0.0 && std::isfinite(r))))
+                    {
+                        return std::make_unique<const BinaryExpression>(std::move(left), make_number(1.0 / r), make_operator(SID::OP_MUL));
+                    }
+                    break;
+            }
+            return std::make_unique<const BinaryExpression>(std::move(left), std::move(right), make_operator(binary_operator));
+        }
+    };
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class Optimizer                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+Optimizer::Optimizer(bool fast_math) :
+    m_fast_math(fast_math),
+    m_nodes_before(0),
+    m_nodes_after(0)
+{}
+
+std::unique_ptr<const Axiom> Optimizer::optimize(const Axiom & axiom)
+{
+    TraceSpan span("optimize");
+    // the rewritten tree gets its own arena, owned by the new Axiom
+    Arena::Scope scope(std::make_shared<Arena>());
+    Rewriter rewriter(m_fast_math);
+    std::unique_ptr<const Axiom> optimized = std::make_unique<const Axiom>(rewriter.rewrite(axiom.expression()));
+    m_nodes_before = count(axiom.expression());
+    m_nodes_after = count(optimized->expression());
+    return optimized;
+}
@@ -0,0 +1,40 @@
+#ifndef OPTIMIZER_H_INCLUDED
+#define OPTIMIZER_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <memory>
+
+// ------------------------------------------------------------ Project Headers
+#include "symbols.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class Optimizer                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Rewrites a parsed Axiom into an equivalent, smaller one: constant subtrees
+// are folded, BracketedExpression wrappers are dropped and identities that
+// hold for every IEEE 754 value (x*1, x/1, x-0, x/2^n -> x*2^-n) are applied.
+// Fast math additionally applies identities that may change the result for
+// signed zeros, infinities, NaNs or rounding (x+0, x*0, x/c -> x*(1/c)).
+class Optimizer
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    Optimizer(bool fast_math = false);
+    Optimizer(const Optimizer & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    std::unique_ptr<const Axiom> optimize(const Axiom & axiom);
+    inline size_t nodes_before() const { return m_nodes_before; }
+    inline size_t nodes_after() const { return m_nodes_after; }
+
+    // --------------------------------------------------- Overloaded Operators
+    Optimizer & operator=(const Optimizer & source) = delete;
+
+private:
+    bool m_fast_math;
+    size_t m_nodes_before;
+    size_t m_nodes_after;
+};
+
+#endif // OPTIMIZER_H_INCLUDED
@@ -0,0 +1,124 @@
+// --------------------------------------------------------- C++ System Headers
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "program.h"
+#include "slots.h"
+#include "symbols.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class Compiler : public ExpressionWalker                                  //
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    // Emits the postfix code of an expression tree
+    class Compiler : public ExpressionWalker
+    {
+    public:
+        Compiler(
+                std::vector<Instruction> & code,
+                std::vector<double> & constants,
+                SlotTable & slots) :
+            m_code(code),
+            m_constants(constants),
+            m_slots(slots),
+            m_depth(0),
+            m_max_depth(0)
+        {}
+
+        inline size_t max_depth() const { return m_max_depth; }
+
+    protected:
+        virtual void leave(const AtomicExpression & expression) override
+        {
+            const AtomicValue & value = expression.atomic_value();
+            if(value == SID::NUM)
+            {
+                m_constants.push_back(((const Number &) value).value());
+                emit(SID::NUM, m_constants.size() - 1);
+            }
+            else
+            {
+                emit(SID::VAR, m_slots.slot(((const Variable &) value).name()));
+            }
+            m_max_depth = std::max(m_max_depth, ++m_depth);
+        }
+
+        virtual void leave(const BinaryExpression & expression) override
+        {
+            emit(expression.binary_operator(), 0);
+            --m_depth;
+        }
+
+    private:
+        std::vector<Instruction> & m_code;
+        std::vector<double> & m_constants;
+        SlotTable & m_slots;
+        size_t m_depth;
+        size_t m_max_depth;
+
+        void emit(int opcode, size_t operand)
+        {
+            m_code.push_back(Instruction{opcode, (unsigned int) operand});
+        }
+    };
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class Program                                                             //
+///////////////////////////////////////////////////////////////////////////////
+
+Program::Program(const Axiom & axiom, const SlotTable & slots) :
+    m_slots(slots)
+{
+    Compiler compiler(m_code, m_constants, m_slots);
+    compiler.walk(axiom.expression());
+    m_stack_size = compiler.max_depth();
+}
+
+double Program::eval(const std::map<std::string, double> & values) const
+{
+    // resolve each distinct variable once per evaluation
+    ValueBuffer dense(m_slots.size());
+    for(size_t i=0; i<m_slots.size(); ++i)
+    {
+        dense.data()[i] = values.at(m_slots.name(i));
+    }
+    return eval(dense.data());
+}
+
+double Program::eval(const double * values) const
+{
+    return run(m_code.data(), m_code.size(), m_constants.data(), m_stack_size, values);
+}
+
+double Program::run(
+        const Instruction * code,
+        size_t size,
+        const double * constants,
+        size_t stack_size,
+        const double * values)
+{
+    ValueBuffer buffer(stack_size);
+    double * stack = buffer.data();
+
+    double * top = stack; // One past the topmost value
+    for(const Instruction * instruction = code; instruction != code + size; ++instruction)
+    {
+        switch(instruction->opcode)
+        {
+            case SID::NUM: *top++ = constants[instruction->operand]; break;
+            case SID::VAR: *top++ = values[instruction->operand]; break;
+            case SID::OP_ADD: --top; top[-1] = top[-1] + top[0]; break;
+            case SID::OP_SUB: --top; top[-1] = top[-1] - top[0]; break;
+            case SID::OP_MUL: --top; top[-1] = top[-1] * top[0]; break;
+            case SID::OP_DIV: --top; top[-1] = top[-1] / top[0]; break;
+        }
+    }
+    return top[-1];
+}
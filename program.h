@@ -0,0 +1,67 @@
+#ifndef PROGRAM_H_INCLUDED
+#define PROGRAM_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <map>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "slots.h"
+#include "symbols.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// struct Instruction                                                        //
+///////////////////////////////////////////////////////////////////////////////
+
+// Opcodes reuse the symbol identifiers: SID::NUM pushes constant `operand`,
+// SID::VAR pushes the value in slot `operand`, SID::OP_xxx pops two values and pushes
+// the result.
+struct Instruction
+{
+    int opcode;
+    unsigned int operand;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class Program                                                             //
+///////////////////////////////////////////////////////////////////////////////
+
+// Postfix bytecode compiled once from an Axiom and evaluated many times by a
+// single interpreter loop instead of a virtual call per tree node.
+class Program
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    Program(const Axiom & axiom, const SlotTable & slots = SlotTable());
+    Program(const Program & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    double eval(const std::map<std::string, double> & values) const;
+    double eval(const double * values) const;
+    inline const SlotTable & slots() const { return m_slots; }
+    inline size_t size() const { return m_code.size(); }
+    inline const std::vector<Instruction> & code() const { return m_code; }
+    inline const std::vector<double> & constants() const { return m_constants; }
+    inline size_t stack_size() const { return m_stack_size; }
+
+    // The interpreter loop behind eval(), also runs code that lives outside
+    // of a Program (see StoredProgram)
+    static double run(
+            const Instruction * code,
+            size_t size,
+            const double * constants,
+            size_t stack_size,
+            const double * values);
+
+    // --------------------------------------------------- Overloaded Operators
+    Program & operator=(const Program & source) = delete;
+
+private:
+    std::vector<Instruction> m_code;
+    std::vector<double> m_constants;
+    SlotTable m_slots;
+    size_t m_stack_size;
+};
+
+#endif // PROGRAM_H_INCLUDED
@@ -0,0 +1,146 @@
+// --------------------------------------------------------- C++ System Headers
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "dag.h"
+#include "reactive.h"
+#include "symbols.h"
+
+namespace {
+
+    double apply(int opcode, double left, double right)
+    {
+        switch(opcode)
+        {
+            case SID::OP_ADD: return left + right;
+            case SID::OP_SUB: return left - right;
+            case SID::OP_MUL: return left * right;
+        }
+        return left / right;
+    }
+
+    // +0 and -0 compare equal but 1/x tells them apart, hence the bitwise
+    // comparison; NaN compares unequal to itself but recomputing it changes
+    // nothing
+    bool same(double a, double b)
+    {
+        return std::memcmp(&a, &b, sizeof(double)) == 0 || (std::isnan(a) && std::isnan(b));
+    }
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class ReactiveNetwork                                                     //
+///////////////////////////////////////////////////////////////////////////////
+
+// Adds a formula evaluated with the current variable values, NaN for the
+// ones never set, and returns its index
+size_t ReactiveNetwork::add(const Axiom & axiom)
+{
+    // the DAG merges the common subexpressions of the formula and lists its
+    // nodes children first, which the network keeps
+    ExpressionDag dag(axiom);
+    std::vector<unsigned int> index(dag.size());
+    for(size_t i=0; i<dag.size(); ++i)
+    {
+        const ExpressionDag::Node & node = dag.nodes()[i];
+        switch(node.opcode)
+        {
+            case SID::NUM:
+                index[i] = push(Node{SID::NUM, 0, 0}, node.value);
+                break;
+            case SID::VAR:
+                index[i] = variable(dag.slots().name(node.left));
+                break;
+            default:
+            {
+                unsigned int left = index[node.left];
+                unsigned int right = index[node.right];
+                index[i] = push(Node{node.opcode, left, right}, apply(node.opcode, m_cache[left], m_cache[right]));
+                m_parents[left].push_back(index[i]);
+                if(right != left)
+                {
+                    m_parents[right].push_back(index[i]);
+                }
+            }
+        }
+    }
+    m_formulas.push_back(index[dag.root()]);
+    return m_formulas.size() - 1;
+}
+
+// Records a new variable value, formulas see it after the next update()
+void ReactiveNetwork::set(const std::string & name, double value)
+{
+    unsigned int leaf = variable(name);
+    if(same(m_cache[leaf], value))
+    {
+        return;
+    }
+    m_cache[leaf] = value;
+    for(unsigned int parent : m_parents[leaf])
+    {
+        touch(parent);
+    }
+}
+
+// Recomputes the nodes depending on the variables set since the last update,
+// returns the number of nodes recomputed
+size_t ReactiveNetwork::update()
+{
+    // children have smaller indices than their parents: popping the
+    // smallest dirty node first recomputes each node after all its inputs
+    size_t recomputed = 0;
+    while(!m_dirty.empty())
+    {
+        unsigned int i = m_dirty.top();
+        m_dirty.pop();
+        m_queued[i] = false;
+        ++recomputed;
+
+        const Node & node = m_nodes[i];
+        double value = apply(node.opcode, m_cache[node.left], m_cache[node.right]);
+        if(same(m_cache[i], value))
+        {
+            continue;
+        }
+        m_cache[i] = value;
+        for(unsigned int parent : m_parents[i])
+        {
+            touch(parent);
+        }
+    }
+    return recomputed;
+}
+
+unsigned int ReactiveNetwork::variable(const std::string & name)
+{
+    auto it = m_variables.find(name);
+    if(it == m_variables.end())
+    {
+        it = m_variables.emplace(name, push(Node{SID::VAR, 0, 0}, NAN)).first;
+    }
+    return it->second;
+}
+
+unsigned int ReactiveNetwork::push(const Node & node, double value)
+{
+    m_nodes.push_back(node);
+    m_cache.push_back(value);
+    m_parents.emplace_back();
+    m_queued.push_back(false);
+    return m_nodes.size() - 1;
+}
+
+void ReactiveNetwork::touch(unsigned int node)
+{
+    if(!m_queued[node])
+    {
+        m_queued[node] = true;
+        m_dirty.push(node);
+    }
+}
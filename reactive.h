@@ -0,0 +1,66 @@
+#ifndef REACTIVE_H_INCLUDED
+#define REACTIVE_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <functional>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "symbols.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class ReactiveNetwork                                                     //
+///////////////////////////////////////////////////////////////////////////////
+
+// Live formulas kept evaluated while their variables change. Every node
+// caches its last value and knows the nodes that read it; variables are leaf
+// nodes shared by all formulas. set() only records a new value, update()
+// then recomputes the nodes downstream of the changed variables, each at
+// most once however many of its inputs changed, and stops where a value
+// comes out unchanged.
+class ReactiveNetwork
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    ReactiveNetwork() = default;
+    ReactiveNetwork(const ReactiveNetwork & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    size_t add(const Axiom & axiom);
+    void set(const std::string & name, double value);
+    size_t update();
+    inline double value(size_t formula) const { return m_cache[m_formulas[formula]]; }
+    inline size_t formulas() const { return m_formulas.size(); }
+    inline size_t size() const { return m_nodes.size(); }
+
+    // --------------------------------------------------- Overloaded Operators
+    ReactiveNetwork & operator=(const ReactiveNetwork & source) = delete;
+
+private:
+    // Nodes are stored children first, SID::OP_xxx nodes read the nodes
+    // `left` and `right`, SID::NUM and SID::VAR nodes only their cache
+    struct Node
+    {
+        int opcode;
+        unsigned int left;
+        unsigned int right;
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<double> m_cache;
+    std::vector<std::vector<unsigned int>> m_parents;
+    std::vector<unsigned int> m_formulas;            // Root node of each formula
+    std::map<std::string, unsigned int> m_variables; // Leaf node of each variable
+    std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<unsigned int>> m_dirty;
+    std::vector<bool> m_queued;
+
+    // ----------------------------------------------- Private Member Functions
+    unsigned int variable(const std::string & name);
+    unsigned int push(const Node & node, double value);
+    void touch(unsigned int node);
+};
+
+#endif // REACTIVE_H_INCLUDED
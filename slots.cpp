@@ -0,0 +1,46 @@
+// --------------------------------------------------------- C++ System Headers
+#include <map>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "slots.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class SlotTable                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+size_t SlotTable::slot(const std::string & name)
+{
+    auto it = m_slots.find(name);
+    if(it == m_slots.end())
+    {
+        it = m_slots.emplace(name, m_names.size()).first;
+        m_names.push_back(name);
+    }
+    return it->second;
+}
+
+std::vector<double> SlotTable::values(const std::map<std::string, double> & values) const
+{
+    std::vector<double> dense(m_names.size());
+    for(size_t i=0; i<m_names.size(); ++i)
+    {
+        dense[i] = values.at(m_names[i]);
+    }
+    return dense;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class ValueBuffer                                                         //
+///////////////////////////////////////////////////////////////////////////////
+
+ValueBuffer::ValueBuffer(size_t size) :
+    m_data(m_local)
+{
+    if(size > LOCAL_SIZE)
+    {
+        m_heap.resize(size);
+        m_data = m_heap.data();
+    }
+}
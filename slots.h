@@ -0,0 +1,62 @@
+#ifndef SLOTS_H_INCLUDED
+#define SLOTS_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <map>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// class SlotTable                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Assigns a dense integer slot to each distinct variable name, so that
+// expressions are evaluated against an array of doubles indexed by slot. An
+// Axiom numbers its own variables (Axiom::slots), Program and ExpressionDag
+// resolve names to slots when they are built.
+class SlotTable
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    SlotTable() = default;
+
+    // ------------------------------------------------ Public Member Functions
+    size_t slot(const std::string & name);
+    std::vector<double> values(const std::map<std::string, double> & values) const;
+    inline const std::string & name(size_t slot) const { return m_names[slot]; }
+    inline size_t size() const { return m_names.size(); }
+
+private:
+    std::map<std::string, size_t> m_slots;
+    std::vector<std::string> m_names;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class ValueBuffer                                                         //
+///////////////////////////////////////////////////////////////////////////////
+
+// Doubles used by one evaluation, values by slot or an operand stack: up to
+// LOCAL_SIZE of them live in the buffer itself, on the stack of its caller,
+// so that small expressions are evaluated without allocating.
+class ValueBuffer
+{
+public:
+    static const size_t LOCAL_SIZE = 64;
+
+    // ----------------------------------------------- Constructor / Destructor
+    ValueBuffer(size_t size);
+    ValueBuffer(const ValueBuffer & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    inline double * data() { return m_data; }
+
+    // --------------------------------------------------- Overloaded Operators
+    ValueBuffer & operator=(const ValueBuffer & source) = delete;
+
+private:
+    double m_local[LOCAL_SIZE];
+    std::vector<double> m_heap;
+    double * m_data;
+};
+
+#endif // SLOTS_H_INCLUDED
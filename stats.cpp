@@ -0,0 +1,166 @@
+// --------------------------------------------------------- C++ System Headers
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+
+// ------------------------------------------------------------ Project Headers
+#include "stats.h"
+#include "symbols.h"
+
+namespace {
+
+    const char * const PRODUCTION_NAMES[Stats::PRODUCTIONS] = {
+        "AXIOM -> EXP",
+        "EXP -> EXP + EXP",
+        "EXP -> EXP - EXP",
+        "EXP -> EXP * EXP",
+        "EXP -> EXP / EXP",
+        "EXP -> ( EXP )",
+        "EXP -> NUM",
+        "EXP -> VAR"
+    };
+
+    std::mutex g_total_mutex;
+    Stats g_total; // Stats of the exited threads
+
+    ///////////////////////////////////////////////////////////////////////////
+    // struct ThreadStats                                                    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    struct ThreadStats
+    {
+        Stats stats;
+
+        ~ThreadStats()
+        {
+            std::lock_guard<std::mutex> lock(g_total_mutex);
+            g_total.merge(stats);
+        }
+    };
+
+    thread_local ThreadStats t_stats;
+
+    double milliseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class Stats                                                               //
+///////////////////////////////////////////////////////////////////////////////
+
+Stats::Stats() :
+    tokens(0),
+    refills(0),
+    shifts(0),
+    reduces(),
+    max_states(0),
+    max_symbols(0),
+    errors(0),
+    recoveries(0),
+    allocations(0),
+    allocated_bytes(0),
+    chunks(0),
+    time()
+{}
+
+void Stats::merge(const Stats & stats)
+{
+    tokens += stats.tokens;
+    refills += stats.refills;
+    shifts += stats.shifts;
+    for(int i=0; i<PRODUCTIONS; ++i)
+    {
+        reduces[i] += stats.reduces[i];
+    }
+    max_states = std::max(max_states, stats.max_states);
+    max_symbols = std::max(max_symbols, stats.max_symbols);
+    errors += stats.errors;
+    recoveries += stats.recoveries;
+    allocations += stats.allocations;
+    allocated_bytes += stats.allocated_bytes;
+    chunks += stats.chunks;
+    for(int i=0; i<PHASES; ++i)
+    {
+        time[i] += stats.time[i];
+    }
+}
+
+void Stats::print(std::ostream & output) const
+{
+    size_t total_reduces = 0;
+    for(int i=0; i<PRODUCTIONS; ++i)
+    {
+        total_reduces += reduces[i];
+    }
+    output << "[Stats] Tokens: " << tokens << " (" << refills << " refills)" << std::endl;
+    output << "[Stats] Shifts: " << shifts << std::endl;
+    output << "[Stats] Reduces: " << total_reduces << std::endl;
+    for(int i=0; i<PRODUCTIONS; ++i)
+    {
+        output << "[Stats]     " << PRODUCTION_NAMES[i] << ": " << reduces[i] << std::endl;
+    }
+    output << "[Stats] Max stack depth: " << max_states << " states, " << max_symbols << " symbols" << std::endl;
+    output << "[Stats] Syntax errors: " << errors << " (" << recoveries << " recovered)" << std::endl;
+    output << "[Stats] Arena allocations: " << allocations << " (" << allocated_bytes << " bytes, ";
+    output << chunks << " chunks)" << std::endl;
+
+    // lexing happens on demand, during the analysis
+    output << "[Stats] Lex time: " << milliseconds(time[LEX]) << " ms" << std::endl;
+    output << "[Stats] Parse time: " << milliseconds(time[PARSE] - std::min(time[LEX], time[PARSE])) << " ms" << std::endl;
+    output << "[Stats] Eval time: " << milliseconds(time[EVAL]) << " ms" << std::endl;
+}
+
+Stats & Stats::current()
+{
+    return t_stats.stats;
+}
+
+Stats Stats::total()
+{
+    std::lock_guard<std::mutex> lock(g_total_mutex);
+    Stats total = g_total;
+    total.merge(current());
+    return total;
+}
+
+Stats::Production Stats::production(const Symbol & symbol)
+{
+    if(symbol == SID::AXIOM)
+    {
+        return P_AXIOM;
+    }
+    if(const BinaryExpression * binary = dynamic_cast<const BinaryExpression *>(&symbol))
+    {
+        switch(binary->binary_operator())
+        {
+            case SID::OP_ADD: return P_ADD;
+            case SID::OP_SUB: return P_SUB;
+            case SID::OP_MUL: return P_MUL;
+        }
+        return P_DIV;
+    }
+    if(dynamic_cast<const BracketedExpression *>(&symbol) != nullptr)
+    {
+        return P_BRACKETS;
+    }
+    const AtomicExpression & atomic = (const AtomicExpression &) symbol;
+    return atomic.atomic_value() == SID::NUM ? P_NUM : P_VAR;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class Stats::Timer                                                        //
+///////////////////////////////////////////////////////////////////////////////
+
+Stats::Timer::Timer(Phase phase) :
+    m_phase(phase),
+    m_start(std::chrono::steady_clock::now())
+{}
+
+Stats::Timer::~Timer()
+{
+    current().time[m_phase] += std::chrono::steady_clock::now() - m_start;
+}
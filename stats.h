@@ -0,0 +1,111 @@
+#ifndef STATS_H_INCLUDED
+#define STATS_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+
+// ------------------------------------------------------- Forward Declarations
+class Symbol;
+
+///////////////////////////////////////////////////////////////////////////////
+// class Stats                                                               //
+///////////////////////////////////////////////////////////////////////////////
+
+// Counters of the lexer, the parsers and the arena, and the time spent in
+// each phase. Every thread counts into its own Stats, merged into the process
+// totals when the thread exits. Nothing is counted unless the build defines
+// LR1_STATS (cmake -DLR1_STATS=ON): the LR1_STATS_* macros below expand to
+// nothing otherwise.
+class Stats
+{
+public:
+    enum Production {
+        P_AXIOM,                    // AXIOM -> EXP
+        P_ADD,                      // EXP -> EXP + EXP
+        P_SUB,                      // EXP -> EXP - EXP
+        P_MUL,                      // EXP -> EXP * EXP
+        P_DIV,                      // EXP -> EXP / EXP
+        P_BRACKETS,                 // EXP -> ( EXP )
+        P_NUM,                      // EXP -> NUM
+        P_VAR,                      // EXP -> VAR
+        PRODUCTIONS
+    };
+
+    enum Phase {
+        LEX,                        // Lexer::top, refills included
+        PARSE,                      // Parsers, lexing included
+        EVAL,                       // Binding, compilation and evaluation
+        PHASES
+    };
+
+    // ----------------------------------------------- Constructor / Destructor
+    Stats();
+    Stats(const Stats & source) = default;
+
+    // ------------------------------------------------ Public Member Functions
+    void merge(const Stats & stats);
+    void print(std::ostream & output) const;
+
+    // Stats of the calling thread
+    static Stats & current();
+    // Stats of the exited threads merged with those of the calling thread
+    static Stats total();
+    // Production a FiniteStateMachine reduction used, from the symbol it made
+    static Production production(const Symbol & symbol);
+
+    // --------------------------------------------------- Overloaded Operators
+    Stats & operator=(const Stats & source) = default;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // class Stats::Timer                                                    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Adds its lifetime to a phase of the calling thread
+    class Timer
+    {
+    public:
+        Timer(Phase phase);
+        Timer(const Timer & source) = delete;
+        ~Timer();
+
+        Timer & operator=(const Timer & source) = delete;
+
+    private:
+        Phase m_phase;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    size_t tokens;                  // Symbols made by the lexer
+    size_t refills;                 // Reads from a stream
+    size_t shifts;
+    size_t reduces[PRODUCTIONS];
+    size_t max_states;              // Deepest state stack
+    size_t max_symbols;             // Deepest symbol stack
+    size_t errors;                  // Syntax errors, recovered or not
+    size_t recoveries;              // Tokens discarded before going on
+    size_t allocations;             // Symbols and strings carved from arenas
+    size_t allocated_bytes;
+    size_t chunks;                  // Chunks the arenas got from the heap
+    std::chrono::steady_clock::duration time[PHASES];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Instrumentation Macros                                                    //
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef LR1_STATS
+#define LR1_STATS_COUNT(COUNTER) (++Stats::current().COUNTER)
+#define LR1_STATS_ADD(COUNTER, N) (Stats::current().COUNTER += (N))
+#define LR1_STATS_MAX(COUNTER, N) (Stats::current().COUNTER = std::max(Stats::current().COUNTER, (size_t) (N)))
+#define LR1_STATS_TIME(PHASE) Stats::Timer stats_timer_##PHASE(Stats::PHASE)
+#else
+#define LR1_STATS_COUNT(COUNTER) ((void) 0)
+#define LR1_STATS_ADD(COUNTER, N) ((void) 0)
+#define LR1_STATS_MAX(COUNTER, N) ((void) 0)
+#define LR1_STATS_TIME(PHASE) ((void) 0)
+#endif
+
+#endif // STATS_H_INCLUDED
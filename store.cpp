@@ -0,0 +1,287 @@
+// --------------------------------------------------------- C++ System Headers
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "fsm.h"
+#include "lexer.h"
+#include "mapped.h"
+#include "program.h"
+#include "slots.h"
+#include "store.h"
+#include "symbols.h"
+
+namespace {
+
+    const char MAGIC[8] = { 'L', 'R', '1', 'S', 'T', 'O', 'R', 'E' };
+    const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+    const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+    // the layout is the file format
+    static_assert(sizeof(StoreHeader) == 64, "StoreHeader must be 64 bytes");
+    static_assert(sizeof(StoreRecord) == 48, "StoreRecord must be 48 bytes");
+    static_assert(sizeof(Instruction) == 8, "Instruction must be 8 bytes");
+
+    size_t align(size_t offset)
+    {
+        return (offset + 7) & ~(size_t) 7;
+    }
+
+    // Appends bytes at an 8-byte aligned offset, returns that offset
+    uint64_t append(std::vector<char> & file, const void * bytes, size_t size)
+    {
+        size_t offset = align(file.size());
+        file.resize(align(offset + size));
+        if(size > 0)
+        {
+            std::memcpy(file.data() + offset, bytes, size);
+        }
+        return offset;
+    }
+
+    // True if [offset, offset + count * size) lies in a file of file_size
+    // bytes and offset is 8-byte aligned
+    bool inside(uint64_t offset, uint64_t count, size_t size, size_t file_size)
+    {
+        return offset % 8 == 0 && offset <= file_size && count <= (file_size - offset) / size;
+    }
+
+    bool string_inside(const char * data, uint64_t offset, size_t file_size)
+    {
+        return offset < file_size && std::memchr(data + offset, '\0', file_size - offset) != nullptr;
+    }
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class StoredProgram                                                       //
+///////////////////////////////////////////////////////////////////////////////
+
+StoredProgram::StoredProgram(const char * data, const StoreRecord & record) :
+    m_data(data),
+    m_record(record),
+    m_code((const Instruction *) (data + record.code)),
+    m_constants((const double *) (data + record.constants)),
+    m_slots((const uint64_t *) (data + record.slots))
+{}
+
+double StoredProgram::eval(const std::map<std::string, double> & values) const
+{
+    ValueBuffer buffer(m_record.slot_count);
+    double * dense = buffer.data();
+    for(size_t i=0; i<m_record.slot_count; ++i)
+    {
+        dense[i] = values.at(slot_name(i));
+    }
+    return eval(dense);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class ProgramStore                                                        //
+///////////////////////////////////////////////////////////////////////////////
+
+ProgramStore::ProgramStore(const std::string & path, bool verify) :
+    m_file(path),
+    m_records(nullptr),
+    m_size(0)
+{
+    if(!m_file.is_open())
+    {
+        m_error = "Cannot map '" + path + "'";
+        return;
+    }
+    const char * data = m_file.text().data();
+    size_t size = m_file.text().size();
+    const StoreHeader * header = (const StoreHeader *) data;
+    if(size < sizeof(StoreHeader) || std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        m_error = "'" + path + "' is not a store";
+    }
+    else if(header->byte_order != StoreHeader::BYTE_ORDER_MARK)
+    {
+        m_error = "'" + path + "' was built on a machine of another byte order";
+    }
+    else if(header->version != StoreHeader::VERSION)
+    {
+        m_error = "'" + path + "' is a version " + std::to_string(header->version) + " store, not version ";
+        m_error += std::to_string(StoreHeader::VERSION);
+    }
+    else if(header->size != size || size % 8 != 0
+            || !inside(sizeof(StoreHeader), header->count, sizeof(StoreRecord), size))
+    {
+        m_error = "'" + path + "' is truncated";
+    }
+    else if(verify && checksum(data + sizeof(StoreHeader), size - sizeof(StoreHeader)) != header->checksum)
+    {
+        m_error = "'" + path + "' is corrupted (checksum mismatch)";
+    }
+    if(!m_error.empty())
+    {
+        return;
+    }
+    m_records = (const StoreRecord *) (data + sizeof(StoreHeader));
+    m_size = header->count;
+    if(verify && !check_records())
+    {
+        m_error = "'" + path + "' holds an invalid record";
+        m_records = nullptr;
+        m_size = 0;
+    }
+}
+
+uint64_t ProgramStore::checksum(const char * data, size_t size)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for(size_t i=0; i+8<=size; i+=8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * FNV_PRIME;
+    }
+    return hash;
+}
+
+// Checks that a record can be run in place: its blocks lie inside the file,
+// its operands index its own constants and slots and its stack size is the
+// one its code needs
+bool ProgramStore::check(size_t index) const
+{
+    const char * data = m_file.text().data();
+    size_t size = m_file.text().size();
+    const StoreRecord & record = m_records[index];
+    if(!string_inside(data, record.text, size)
+            || !inside(record.code, record.code_size, sizeof(Instruction), size)
+            || !inside(record.constants, record.constant_count, sizeof(double), size)
+            || !inside(record.slots, record.slot_count, sizeof(uint64_t), size))
+    {
+        return false;
+    }
+    const uint64_t * slots = (const uint64_t *) (data + record.slots);
+    for(size_t slot=0; slot<record.slot_count; ++slot)
+    {
+        if(!string_inside(data, slots[slot], size))
+        {
+            return false;
+        }
+    }
+    const Instruction * code = (const Instruction *) (data + record.code);
+    size_t depth = 0;
+    size_t max_depth = 0;
+    for(size_t j=0; j<record.code_size; ++j)
+    {
+        switch(code[j].opcode)
+        {
+            case SID::NUM:
+            case SID::VAR:
+            {
+                size_t limit = code[j].opcode == SID::NUM ? record.constant_count : record.slot_count;
+                if(code[j].operand >= limit)
+                {
+                    return false;
+                }
+                max_depth = std::max(max_depth, ++depth);
+                break;
+            }
+            case SID::OP_ADD:
+            case SID::OP_SUB:
+            case SID::OP_MUL:
+            case SID::OP_DIV:
+                if(depth-- < 2)
+                {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+    // the stack size is that of the code, which run() allocates
+    if(depth != 1 || max_depth != record.stack_size)
+    {
+        return false;
+    }
+    return true;
+}
+
+bool ProgramStore::check_records() const
+{
+    for(size_t i=0; i<m_size; ++i)
+    {
+        if(!check(i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class StoreBuilder                                                        //
+///////////////////////////////////////////////////////////////////////////////
+
+// False if expression is invalid, it is not added then
+bool StoreBuilder::add(std::string_view expression)
+{
+    Lexer lexer(expression);
+    FiniteStateMachine fsm(lexer);
+    std::unique_ptr<const Axiom> axiom = fsm.analyze();
+    if(axiom.get() == nullptr)
+    {
+        return false;
+    }
+    m_texts.emplace_back(expression);
+    m_programs.push_back(std::make_unique<const Program>(*axiom));
+    return true;
+}
+
+bool StoreBuilder::write(std::ostream & output) const
+{
+    std::vector<char> file(sizeof(StoreHeader) + m_programs.size() * sizeof(StoreRecord));
+    std::vector<StoreRecord> records(m_programs.size());
+    std::vector<uint64_t> names;
+    std::map<std::string, uint64_t> name_offsets; // Each name is written once
+    for(size_t i=0; i<m_programs.size(); ++i)
+    {
+        const Program & program = *m_programs[i];
+        StoreRecord & record = records[i];
+        record.text = append(file, m_texts[i].c_str(), m_texts[i].size() + 1);
+        record.code = append(file, program.code().data(), program.size() * sizeof(Instruction));
+        record.constants = append(file, program.constants().data(), program.constants().size() * sizeof(double));
+        names.resize(program.slots().size());
+        for(size_t slot=0; slot<names.size(); ++slot)
+        {
+            const std::string & name = program.slots().name(slot);
+            auto found = name_offsets.find(name);
+            if(found == name_offsets.end())
+            {
+                found = name_offsets.emplace(name, append(file, name.c_str(), name.size() + 1)).first;
+            }
+            names[slot] = found->second;
+        }
+        record.slots = append(file, names.data(), names.size() * sizeof(uint64_t));
+        record.code_size = (uint32_t) program.size();
+        record.constant_count = (uint32_t) program.constants().size();
+        record.slot_count = (uint32_t) names.size();
+        record.stack_size = (uint32_t) program.stack_size();
+    }
+    std::memcpy(file.data() + sizeof(StoreHeader), records.data(), records.size() * sizeof(StoreRecord));
+
+    StoreHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = StoreHeader::VERSION;
+    header.byte_order = StoreHeader::BYTE_ORDER_MARK;
+    header.count = m_programs.size();
+    header.size = file.size();
+    header.checksum = ProgramStore::checksum(file.data() + sizeof(StoreHeader), file.size() - sizeof(StoreHeader));
+    std::memcpy(file.data(), &header, sizeof(header));
+    output.write(file.data(), file.size());
+    output.flush();
+    return (bool) output;
+}
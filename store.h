@@ -0,0 +1,160 @@
+#ifndef STORE_H_INCLUDED
+#define STORE_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "mapped.h"
+#include "program.h"
+
+// A store file holds compiled Programs, laid out to be used in place:
+//
+//     Header          64 bytes, see StoreHeader
+//     Records         StoreHeader::count StoreRecord, one per expression
+//     Data            texts, code, constants and slot names, each block
+//                     8-byte aligned and addressed by its file offset
+//
+// Numbers are written in the byte order of the machine that built the store,
+// which must match the one reading it. The checksum is FNV-1a taken over the
+// 64-bit words following the header.
+
+///////////////////////////////////////////////////////////////////////////////
+// struct StoreHeader                                                        //
+///////////////////////////////////////////////////////////////////////////////
+
+struct StoreHeader
+{
+    char magic[8];                  // "LR1STORE"
+    uint32_t version;
+    uint32_t byte_order;            // BYTE_ORDER_MARK as written
+    uint64_t count;                 // Expressions
+    uint64_t size;                  // Of the whole file
+    uint64_t checksum;
+    uint64_t reserved[3];
+
+    static const uint32_t VERSION = 1;
+    static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// struct StoreRecord                                                        //
+///////////////////////////////////////////////////////////////////////////////
+
+struct StoreRecord
+{
+    uint64_t text;                  // Offset of the NUL-terminated text
+    uint64_t code;                  // Offset of code_size Instruction
+    uint64_t constants;             // Offset of constant_count double
+    uint64_t slots;                 // Offset of slot_count name offsets
+    uint32_t code_size;
+    uint32_t constant_count;
+    uint32_t slot_count;
+    uint32_t stack_size;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class StoredProgram                                                       //
+///////////////////////////////////////////////////////////////////////////////
+
+// A Program read in place from a ProgramStore, valid as long as the store
+class StoredProgram
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    StoredProgram(const char * data, const StoreRecord & record);
+
+    // ------------------------------------------------ Public Member Functions
+    double eval(const std::map<std::string, double> & values) const;
+    inline double eval(const double * values) const
+    {
+        return Program::run(m_code, m_record.code_size, m_constants, m_record.stack_size, values);
+    }
+    inline const char * text() const { return m_data + m_record.text; }
+    inline size_t slots() const { return m_record.slot_count; }
+    inline const char * slot_name(size_t slot) const { return m_data + m_slots[slot]; }
+    inline size_t size() const { return m_record.code_size; }
+
+private:
+    const char * m_data;
+    const StoreRecord & m_record;
+    const Instruction * m_code;
+    const double * m_constants;
+    const uint64_t * m_slots;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class ProgramStore                                                        //
+///////////////////////////////////////////////////////////////////////////////
+
+// Store file mapped in memory: nothing is parsed nor allocated per
+// expression, program(i) is a view of the mapped bytes. Opening checks the
+// header; verify also checks the checksum and that every record stays inside
+// the file, which reads it all. Without verify, check(i) must hold before
+// program(i) is run.
+class ProgramStore
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    ProgramStore(const std::string & path, bool verify = true);
+    ProgramStore(const ProgramStore & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    inline bool is_open() const { return m_error.empty(); }
+    inline const std::string & error() const { return m_error; }
+    inline size_t size() const { return m_size; }
+    bool check(size_t index) const;
+    inline StoredProgram program(size_t index) const
+    {
+        return StoredProgram(m_file.text().data(), m_records[index]);
+    }
+
+    // FNV-1a over the 64-bit words of data, size is a multiple of 8
+    static uint64_t checksum(const char * data, size_t size);
+
+    // --------------------------------------------------- Overloaded Operators
+    ProgramStore & operator=(const ProgramStore & source) = delete;
+
+private:
+    MappedFile m_file;
+    std::string m_error;
+    const StoreRecord * m_records;
+    size_t m_size;
+
+    // ----------------------------------------------- Private Member Functions
+    bool check_records() const;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class StoreBuilder                                                        //
+///////////////////////////////////////////////////////////////////////////////
+
+// Parses and compiles expressions, then writes them as a store file
+class StoreBuilder
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    StoreBuilder() = default;
+    StoreBuilder(const StoreBuilder & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    bool add(std::string_view expression);
+    bool write(std::ostream & output) const;
+    inline size_t size() const { return m_texts.size(); }
+
+    // --------------------------------------------------- Overloaded Operators
+    StoreBuilder & operator=(const StoreBuilder & source) = delete;
+
+private:
+    std::vector<std::string> m_texts;
+    std::vector<std::unique_ptr<const Program>> m_programs;
+};
+
+#endif // STORE_H_INCLUDED
@@ -0,0 +1,112 @@
+// --------------------------------------------------------- C++ System Headers
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+// ------------------------------------------------------------ Project Headers
+#include "store.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Store tool                                                                //
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char **argv)
+{
+    bool build = argc == 4 && std::strcmp(argv[1], "build") == 0;
+    bool verify = argc == 3 && std::strcmp(argv[1], "verify") == 0;
+    bool eval = argc >= 4 && argc%2 == 0 && std::strcmp(argv[1], "eval") == 0;
+    if(!build && !verify && !eval)
+    {
+        std::cout << "Usage: ./LR1Store build FORMULAS STORE" << std::endl;
+        std::cout << "       ./LR1Store verify STORE" << std::endl;
+        std::cout << "       ./LR1Store eval STORE INDEX [VAR_NAME VAR_VALUE]*" << std::endl;
+        return -1;
+    }
+
+    // one formula per line, the index of a formula is its line number - 1
+    if(build)
+    {
+        std::ifstream formulas(argv[2]);
+        if(!formulas)
+        {
+            std::cerr << "[Error] Cannot open '" << argv[2] << "'" << std::endl;
+            return -1;
+        }
+        StoreBuilder builder;
+        std::string line;
+        size_t number = 0;
+        bool valid = true;
+        while(std::getline(formulas, line))
+        {
+            ++number;
+            if(!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            if(!builder.add(line))
+            {
+                std::cerr << "[Error] Line " << number << ": invalid arithmetic expression" << std::endl;
+                valid = false;
+            }
+        }
+        if(!valid)
+        {
+            return -1;
+        }
+        std::ofstream store(argv[3], std::ios::binary);
+        if(!store || !builder.write(store))
+        {
+            std::cerr << "[Error] Cannot write '" << argv[3] << "'" << std::endl;
+            return -1;
+        }
+        std::cout << "Stored " << builder.size() << " expressions" << std::endl;
+        return 0;
+    }
+
+    ProgramStore store(argv[2], verify);
+    if(!store.is_open())
+    {
+        std::cerr << "[Error] " << store.error() << std::endl;
+        return -1;
+    }
+    if(verify)
+    {
+        std::cout << "Verified " << store.size() << " expressions" << std::endl;
+        return 0;
+    }
+
+    size_t index = std::strtoul(argv[3], nullptr, 10);
+    if(index >= store.size())
+    {
+        std::cerr << "[Error] No expression " << index << " in a store of " << store.size() << std::endl;
+        return -1;
+    }
+    // eval skips the checksum, which reads the whole file, not the checks of
+    // the one record it runs
+    if(!store.check(index))
+    {
+        std::cerr << "[Error] Expression " << index << " is an invalid record" << std::endl;
+        return -1;
+    }
+    std::map<std::string, double> values;
+    for(int i=4; i<argc; i+=2)
+    {
+        values[argv[i]] = std::atof(argv[i+1]);
+    }
+    StoredProgram program = store.program(index);
+    try
+    {
+        double value = program.eval(values);
+        std::cout << program.text() << " = " << value << std::endl;
+    }
+    catch(const std::out_of_range &)
+    {
+        std::cerr << "[Error] Unbound variable" << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -1,10 +1,18 @@
 // --------------------------------------------------------- C++ System Headers
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
 #include <map>
 #include <memory>
-#include <sstream>
+#include <mutex>
+#include <new>
 #include <string>
+#include <vector>
 
 // ------------------------------------------------------------ Project Headers
+#include "arena.h"
+#include "slots.h"
 #include "symbols.h"
 
 // --------------------------------------------------------------------- Macros
@@ -19,6 +27,32 @@ Symbol::Symbol(int identifier, bool terminal) :
     m_terminal(terminal)
 {}
 
+// Arena blocks and heap blocks both start on a 16-byte boundary: symbols
+// carved from an arena start 8 bytes past it, which tells them apart from
+// heap symbols at no cost for the latter
+static const size_t ARENA_OFFSET = 8;
+static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ % (2 * ARENA_OFFSET) == 0, "heap blocks must be 16-byte aligned");
+static_assert(alignof(std::max_align_t) % (2 * ARENA_OFFSET) == 0, "arena blocks must be 16-byte aligned");
+
+void * Symbol::operator new(size_t size)
+{
+    const std::shared_ptr<Arena> & arena = Arena::current();
+    if(arena)
+    {
+        return (char *) arena->allocate(size + ARENA_OFFSET) + ARENA_OFFSET;
+    }
+    return ::operator new(size);
+}
+
+void Symbol::operator delete(void * pointer)
+{
+    // arena symbols are released in bulk with their arena
+    if((size_t) pointer % (2 * ARENA_OFFSET) != ARENA_OFFSET)
+    {
+        ::operator delete(pointer);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class EndOfStream : public Symbol                                         //
 ///////////////////////////////////////////////////////////////////////////////
@@ -140,11 +174,23 @@ Number::Number(double value) :
 
 std::string Number::text() const
 {
-    std::string value_str;
-    std::stringstream stream;
-    stream << m_value;
-    stream >> value_str;
-    return value_str;
+    return format(m_value);
+}
+
+// Shortest text the lexer reads back as the same value: fixed notation, since
+// the lexer would split the signed exponent of 1e+300 or 1e-300 at its sign,
+// and negative values (which only folding makes) as a bracketed subtraction
+// from 0, since the grammar has no unary minus.
+// Negative zero, infinities and NaN have no text in the grammar.
+std::string Number::format(double value)
+{
+    if(value < 0.0 && std::isfinite(value))
+    {
+        return "(0-" + format(-value) + ")";
+    }
+    char buffer[512]; // The longest, of the smallest subnormal, has 326
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed);
+    return std::string(buffer, result.ptr);
 }
 
 double Number::eval(const std::map<std::string, double> & values) const
@@ -153,23 +199,44 @@ double Number::eval(const std::map<std::string, double> & values) const
     return m_value;
 }
 
+double Number::eval(const double * values) const
+{
+    UNUSED_PARAMETER(values);
+    return m_value;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class Variable : public AtomicValue                                       //
 ///////////////////////////////////////////////////////////////////////////////
 
 Variable::Variable(const std::string & name) :
     AtomicValue(SID::VAR),
-    m_name(name)
+    m_interned(Arena::current() != nullptr),
+    m_name(m_interned ? &Arena::current()->intern(name) : new std::string(name)),
+    m_slot(0)
 {}
 
+Variable::~Variable()
+{
+    if(!m_interned)
+    {
+        delete m_name;
+    }
+}
+
 std::string Variable::text() const
 {
-    return m_name;
+    return *m_name;
 }
 
 double Variable::eval(const std::map<std::string, double> & values) const
 {
-    return values.at(m_name);
+    return values.at(*m_name);
+}
+
+double Variable::eval(const double * values) const
+{
+    return values[m_slot];
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -198,6 +265,142 @@ double AtomicExpression::eval(const std::map<std::string, double> & values) cons
     return m_atomic_value->eval(values);
 }
 
+double AtomicExpression::eval(const double * values) const
+{
+    return m_atomic_value->eval(values);
+}
+
+void AtomicExpression::accept(ExpressionVisitor & visitor) const
+{
+    visitor.visit(*this);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class Evaluator : public ExpressionWalker                                 //
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    // Evaluates an expression against values by name or by slot: the values
+    // of the operands of an operator are the topmost of a stack
+    template<class Values>
+    class Evaluator : public ExpressionWalker
+    {
+    public:
+        Evaluator(const Values & values) :
+            m_values(values)
+        {}
+
+        double eval(const Expression & expression)
+        {
+            walk(expression);
+            return m_stack.back();
+        }
+
+    protected:
+        virtual void leave(const AtomicExpression & expression) override
+        {
+            m_stack.push_back(expression.eval(m_values));
+        }
+
+        virtual void leave(const BinaryExpression & expression) override
+        {
+            double right = m_stack.back();
+            m_stack.pop_back();
+            m_stack.back() = expression.binary_operator().eval(m_stack.back(), right);
+        }
+
+    private:
+        const Values & m_values;
+        std::vector<double> m_stack;
+    };
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class Printer : public ExpressionWalker                                   //
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    // Binding strength of an operand: brackets and atoms bind tightest
+    int precedence(const Expression & expression)
+    {
+        const BinaryExpression * binary = dynamic_cast<const BinaryExpression *>(&expression);
+        if(binary == nullptr)
+        {
+            return 2;
+        }
+        int op = binary->binary_operator();
+        return (op == SID::OP_MUL || op == SID::OP_DIV) ? 1 : 0;
+    }
+
+    // Parsed trees keep their brackets as BracketedExpression nodes, trees
+    // rewritten without them (see Optimizer) get them back here
+    class Printer : public ExpressionWalker
+    {
+    public:
+        std::string text(const Expression & expression)
+        {
+            walk(expression);
+            return m_text;
+        }
+
+    protected:
+        virtual void leave(const AtomicExpression & expression) override
+        {
+            m_text += expression.text();
+        }
+
+        virtual bool enter(const BinaryExpression & expression) override
+        {
+            if(precedence(expression.left_operand()) < precedence(expression))
+            {
+                m_text += '(';
+            }
+            return true;
+        }
+
+        virtual void between(const BinaryExpression & expression) override
+        {
+            if(precedence(expression.left_operand()) < precedence(expression))
+            {
+                m_text += ')';
+            }
+            m_text += expression.binary_operator().text();
+            if(precedence(expression.right_operand()) <= precedence(expression))
+            {
+                m_text += '(';
+            }
+        }
+
+        virtual void leave(const BinaryExpression & expression) override
+        {
+            if(precedence(expression.right_operand()) <= precedence(expression))
+            {
+                m_text += ')';
+            }
+        }
+
+        virtual bool enter(const BracketedExpression & expression) override
+        {
+            UNUSED_PARAMETER(expression);
+            m_text += '(';
+            return true;
+        }
+
+        virtual void leave(const BracketedExpression & expression) override
+        {
+            UNUSED_PARAMETER(expression);
+            m_text += ')';
+        }
+
+    private:
+        std::string m_text;
+    };
+
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class BinaryExpression : public Expression                                //
 ///////////////////////////////////////////////////////////////////////////////
@@ -213,7 +416,8 @@ BinaryExpression::BinaryExpression(
 
 std::string BinaryExpression::text() const
 {
-    return m_left_operand->text() + m_binary_operator->text() + m_right_operand->text();
+    Printer printer;
+    return printer.text(*this);
 }
 
 double BinaryExpression::eval(const std::map<std::string, double> & values) const
@@ -221,6 +425,16 @@ double BinaryExpression::eval(const std::map<std::string, double> & values) cons
     return m_binary_operator->eval(m_left_operand->eval(values), m_right_operand->eval(values));
 }
 
+double BinaryExpression::eval(const double * values) const
+{
+    return m_binary_operator->eval(m_left_operand->eval(values), m_right_operand->eval(values));
+}
+
+void BinaryExpression::accept(ExpressionVisitor & visitor) const
+{
+    visitor.visit(*this);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class BracketedExpression : public Expression                             //
 ///////////////////////////////////////////////////////////////////////////////
@@ -236,7 +450,8 @@ BracketedExpression::BracketedExpression(
 
 std::string BracketedExpression::text() const
 {
-    return m_left_bracket->text() + m_inner_expression->text() + m_right_bracket->text();
+    Printer printer;
+    return printer.text(*this);
 }
 
 double BracketedExpression::eval(const std::map<std::string, double> & values) const
@@ -244,15 +459,233 @@ double BracketedExpression::eval(const std::map<std::string, double> & values) c
     return m_inner_expression->eval(values);
 }
 
+double BracketedExpression::eval(const double * values) const
+{
+    return m_inner_expression->eval(values);
+}
+
+void BracketedExpression::accept(ExpressionVisitor & visitor) const
+{
+    visitor.visit(*this);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class SharedExpression : public Expression                                //
+///////////////////////////////////////////////////////////////////////////////
+
+SharedExpression::SharedExpression(const Expression & shared_expression) :
+    m_shared_expression(shared_expression)
+{}
+
+std::string SharedExpression::text() const
+{
+    return m_shared_expression.text();
+}
+
+double SharedExpression::eval(const std::map<std::string, double> & values) const
+{
+    return m_shared_expression.eval(values);
+}
+
+double SharedExpression::eval(const double * values) const
+{
+    return m_shared_expression.eval(values);
+}
+
+void SharedExpression::accept(ExpressionVisitor & visitor) const
+{
+    m_shared_expression.accept(visitor);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class ExpressionWalker : private ExpressionVisitor                        //
+///////////////////////////////////////////////////////////////////////////////
+
+void ExpressionWalker::walk(const Expression & expression)
+{
+    m_steps.push_back({ &expression, WALK });
+    while(!m_steps.empty())
+    {
+        Step step = m_steps.back();
+        m_steps.pop_back();
+        switch(step.action)
+        {
+            case WALK: step.expression->accept(*this); break;
+            case BETWEEN: between((const BinaryExpression &) *step.expression); break;
+            case LEAVE_BINARY: leave((const BinaryExpression &) *step.expression); break;
+            case LEAVE_BRACKETS: leave((const BracketedExpression &) *step.expression); break;
+        }
+    }
+}
+
+void ExpressionWalker::leave(const AtomicExpression & expression)
+{
+    UNUSED_PARAMETER(expression);
+}
+
+bool ExpressionWalker::enter(const BinaryExpression & expression)
+{
+    UNUSED_PARAMETER(expression);
+    return true;
+}
+
+void ExpressionWalker::between(const BinaryExpression & expression)
+{
+    UNUSED_PARAMETER(expression);
+}
+
+void ExpressionWalker::leave(const BinaryExpression & expression)
+{
+    UNUSED_PARAMETER(expression);
+}
+
+bool ExpressionWalker::enter(const BracketedExpression & expression)
+{
+    UNUSED_PARAMETER(expression);
+    return true;
+}
+
+void ExpressionWalker::leave(const BracketedExpression & expression)
+{
+    UNUSED_PARAMETER(expression);
+}
+
+// Steps are pushed in the reverse of the order they run in
+void ExpressionWalker::visit(const AtomicExpression & expression)
+{
+    leave(expression);
+}
+
+void ExpressionWalker::visit(const BinaryExpression & expression)
+{
+    if(enter(expression))
+    {
+        m_steps.push_back({ &expression, LEAVE_BINARY });
+        m_steps.push_back({ &expression.right_operand(), WALK });
+        m_steps.push_back({ &expression, BETWEEN });
+        m_steps.push_back({ &expression.left_operand(), WALK });
+    }
+}
+
+void ExpressionWalker::visit(const BracketedExpression & expression)
+{
+    if(enter(expression))
+    {
+        m_steps.push_back({ &expression, LEAVE_BRACKETS });
+        m_steps.push_back({ &expression.inner_expression(), WALK });
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class VariableCollector : public ExpressionWalker                         //
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    // Lists the Variable leaves of an expression from left to right and
+    // measures its nesting, in operators and brackets
+    class VariableCollector : public ExpressionWalker
+    {
+    public:
+        VariableCollector() :
+            m_depth(0),
+            m_max_depth(0)
+        {}
+
+        const std::vector<const Variable *> & collect(const Expression & expression)
+        {
+            walk(expression);
+            return m_variables;
+        }
+
+        inline size_t max_depth() const { return m_max_depth; }
+
+    protected:
+        virtual void leave(const AtomicExpression & expression) override
+        {
+            const AtomicValue & value = expression.atomic_value();
+            if(value == SID::VAR)
+            {
+                m_variables.push_back((const Variable *) &value);
+            }
+        }
+
+        virtual bool enter(const BinaryExpression & expression) override
+        {
+            UNUSED_PARAMETER(expression);
+            m_max_depth = std::max(m_max_depth, ++m_depth);
+            return true;
+        }
+
+        virtual void leave(const BinaryExpression & expression) override
+        {
+            UNUSED_PARAMETER(expression);
+            --m_depth;
+        }
+
+        virtual bool enter(const BracketedExpression & expression) override
+        {
+            UNUSED_PARAMETER(expression);
+            m_max_depth = std::max(m_max_depth, ++m_depth);
+            return true;
+        }
+
+        virtual void leave(const BracketedExpression & expression) override
+        {
+            UNUSED_PARAMETER(expression);
+            --m_depth;
+        }
+
+    private:
+        std::vector<const Variable *> m_variables;
+        size_t m_depth;
+        size_t m_max_depth;
+    };
+
+    // Deeper trees are evaluated by an Evaluator rather than by the recursive
+    // eval() of their nodes, which would overflow the call stack
+    const size_t MAX_RECURSION = 10000;
+
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class Axiom : public Symbol                                               //
 ///////////////////////////////////////////////////////////////////////////////
 
 Axiom::Axiom(std::unique_ptr<const Expression> expression) :
     Symbol(SID::AXIOM, false),
-    m_expression(std::move(expression))
+    m_arena(Arena::current()),
+    m_expression(std::move(expression)),
+    m_depth(0)
 {}
 
+Axiom::~Axiom()
+{
+    // arena nodes own no other resource: skip their destructors and let the
+    // arena release them at once (this also avoids deep recursion)
+    if(m_arena)
+    {
+        m_expression.release();
+    }
+}
+
+// The Axiom owns its arena, hence is never allocated from it
+void * Axiom::operator new(size_t size)
+{
+    return ::operator new(size);
+}
+
+void Axiom::operator delete(void * pointer)
+{
+    ::operator delete(pointer);
+}
+
+const SlotTable & Axiom::slots() const
+{
+    bind();
+    return *m_slots;
+}
+
 std::string Axiom::text() const
 {
     return m_expression->text();
@@ -260,5 +693,40 @@ std::string Axiom::text() const
 
 double Axiom::eval(const std::map<std::string, double> & values) const
 {
+    bind();
+    if(m_depth > MAX_RECURSION)
+    {
+        Evaluator<std::map<std::string, double>> evaluator(values);
+        return evaluator.eval(*m_expression);
+    }
+    return m_expression->eval(values);
+}
+
+double Axiom::eval(const double * values) const
+{
+    bind();
+    if(m_depth > MAX_RECURSION)
+    {
+        Evaluator<const double *> evaluator(values);
+        return evaluator.eval(*m_expression);
+    }
     return m_expression->eval(values);
 }
+
+// Numbers the variables in order of first appearance and measures the tree
+// the first time it is called, from whichever thread: the Axiom is the only
+// writer of the slots of its Variables, so that a shared Axiom (see
+// ParseCache, TieredExecutor) is never rebound under its readers
+void Axiom::bind() const
+{
+    std::call_once(m_bound, [this] {
+        std::unique_ptr<SlotTable> slots = std::make_unique<SlotTable>();
+        VariableCollector collector;
+        for(const Variable * variable : collector.collect(*m_expression))
+        {
+            variable->bind(slots->slot(variable->name()));
+        }
+        m_slots = std::move(slots);
+        m_depth = collector.max_depth();
+    });
+}
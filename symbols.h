@@ -4,7 +4,9 @@
 // --------------------------------------------------------- C++ System Headers
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 ///////////////////////////////////////////////////////////////////////////////
 // Constants Definitions                                                     //
@@ -34,6 +36,30 @@ namespace SID {
 
 }
 
+// ------------------------------------------------------- Forward Declarations
+class Arena;
+class AtomicExpression;
+class BinaryExpression;
+class BracketedExpression;
+class SlotTable;
+
+///////////////////////////////////////////////////////////////////////////////
+// class ExpressionVisitor                                                   //
+///////////////////////////////////////////////////////////////////////////////
+
+class ExpressionVisitor
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    ExpressionVisitor() = default;
+    virtual ~ExpressionVisitor() = default;
+
+    // ------------------------------------------------ Public Member Functions
+    virtual void visit(const AtomicExpression & expression) = 0;
+    virtual void visit(const BinaryExpression & expression) = 0;
+    virtual void visit(const BracketedExpression & expression) = 0;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // class Symbol                                                              //
 ///////////////////////////////////////////////////////////////////////////////
@@ -53,6 +79,8 @@ public:
     // --------------------------------------------------- Overloaded Operators
     Symbol & operator=(const Symbol & source) = delete;
     inline operator int() const { return m_identifier; }
+    static void * operator new(size_t size);
+    static void operator delete(void * pointer);
 
 protected:
     const int m_identifier;
@@ -241,6 +269,7 @@ public:
 
     // ------------------------------------------------ Public Member Functions
     virtual double eval(const std::map<std::string, double> & values) const = 0;
+    virtual double eval(const double * values) const = 0;
 
     // --------------------------------------------------- Overloaded Operators
     AtomicValue & operator=(const AtomicValue & source) = delete;
@@ -261,6 +290,9 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual std::string text() const override;
     virtual double eval(const std::map<std::string, double> & values) const override;
+    virtual double eval(const double * values) const override;
+    inline double value() const { return m_value; }
+    static std::string format(double value);
 
     // --------------------------------------------------- Overloaded Operators
     Number & operator=(const Number & source) = delete;
@@ -279,17 +311,27 @@ public:
     // ----------------------------------------------- Constructor / Destructor
     Variable(const std::string & name);
     Variable(const Variable & source) = delete;
-    virtual ~Variable() = default;
+    virtual ~Variable();
 
     // ------------------------------------------------ Public Member Functions
     virtual std::string text() const override;
     virtual double eval(const std::map<std::string, double> & values) const override;
+    virtual double eval(const double * values) const override;
+    inline const std::string & name() const { return *m_name; }
+    inline size_t slot() const { return m_slot; }
 
     // --------------------------------------------------- Overloaded Operators
     Variable & operator=(const Variable & source) = delete;
 
 protected:
-    const std::string m_name;
+    const bool m_interned;         // By an Arena, otherwise owned
+    const std::string * m_name;
+    mutable size_t m_slot; // Index in the values array, set by Axiom::slots
+
+private:
+    // ----------------------------------------------- Private Member Functions
+    friend class Axiom;
+    inline void bind(size_t slot) const { m_slot = slot; }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -306,6 +348,8 @@ public:
 
     // ------------------------------------------------ Public Member Functions
     virtual double eval(const std::map<std::string, double> & values) const = 0;
+    virtual double eval(const double * values) const = 0;
+    virtual void accept(ExpressionVisitor & visitor) const = 0;
 
     // --------------------------------------------------- Overloaded Operators
     Expression & operator=(const Expression & source) = delete;
@@ -326,6 +370,9 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual std::string text() const override;
     virtual double eval(const std::map<std::string, double> & values) const override;
+    virtual double eval(const double * values) const override;
+    virtual void accept(ExpressionVisitor & visitor) const override;
+    inline const AtomicValue & atomic_value() const { return *m_atomic_value; }
 
     // --------------------------------------------------- Overloaded Operators
     AtomicExpression & operator=(const AtomicExpression & source) = delete;
@@ -352,6 +399,11 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual std::string text() const override;
     virtual double eval(const std::map<std::string, double> & values) const override;
+    virtual double eval(const double * values) const override;
+    virtual void accept(ExpressionVisitor & visitor) const override;
+    inline const Expression & left_operand() const { return *m_left_operand; }
+    inline const Expression & right_operand() const { return *m_right_operand; }
+    inline const BinaryOperator & binary_operator() const { return *m_binary_operator; }
 
     // --------------------------------------------------- Overloaded Operators
     BinaryExpression & operator=(const BinaryExpression & source) = delete;
@@ -380,6 +432,9 @@ public:
     // ------------------------------------------------ Public Member Functions
     virtual std::string text() const override;
     virtual double eval(const std::map<std::string, double> & values) const override;
+    virtual double eval(const double * values) const override;
+    virtual void accept(ExpressionVisitor & visitor) const override;
+    inline const Expression & inner_expression() const { return *m_inner_expression; }
 
     // --------------------------------------------------- Overloaded Operators
     BracketedExpression & operator=(const BracketedExpression & source) = delete;
@@ -390,6 +445,84 @@ protected:
     const std::unique_ptr<const ClosedBracket> m_right_bracket;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// class SharedExpression : public Expression                                //
+///////////////////////////////////////////////////////////////////////////////
+
+// Stands for an expression owned by another tree carved from the same Arena
+// (see IncrementalParser): destroying it leaves that expression untouched,
+// and visitors see the shared expression itself.
+class SharedExpression : public Expression
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    SharedExpression(const Expression & shared_expression);
+    SharedExpression(const SharedExpression & source) = delete;
+    virtual ~SharedExpression() = default;
+
+    // ------------------------------------------------ Public Member Functions
+    virtual std::string text() const override;
+    virtual double eval(const std::map<std::string, double> & values) const override;
+    virtual double eval(const double * values) const override;
+    virtual void accept(ExpressionVisitor & visitor) const override;
+    inline const Expression & shared_expression() const { return m_shared_expression; }
+
+    // --------------------------------------------------- Overloaded Operators
+    SharedExpression & operator=(const SharedExpression & source) = delete;
+
+protected:
+    const Expression & m_shared_expression;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class ExpressionWalker : private ExpressionVisitor                        //
+///////////////////////////////////////////////////////////////////////////////
+
+// Walks an expression depth-first, left to right, from a stack of its own
+// rather than by recursion, so that neither the nesting of a tree nor the
+// length of a chain such as a+b+c+... is bounded by the call stack. enter()
+// is called before the operands of a node and skips them when it returns
+// false, between() between the operands of a BinaryExpression, leave() after
+// them. A SharedExpression is walked as the expression it stands for.
+class ExpressionWalker : private ExpressionVisitor
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    ExpressionWalker() = default;
+    ExpressionWalker(const ExpressionWalker & source) = delete;
+    virtual ~ExpressionWalker() = default;
+
+    // ------------------------------------------------ Public Member Functions
+    void walk(const Expression & expression);
+
+    // --------------------------------------------------- Overloaded Operators
+    ExpressionWalker & operator=(const ExpressionWalker & source) = delete;
+
+protected:
+    // --------------------------------------------- Protected Member Functions
+    virtual void leave(const AtomicExpression & expression);
+    virtual bool enter(const BinaryExpression & expression);
+    virtual void between(const BinaryExpression & expression);
+    virtual void leave(const BinaryExpression & expression);
+    virtual bool enter(const BracketedExpression & expression);
+    virtual void leave(const BracketedExpression & expression);
+
+private:
+    enum Action { WALK, BETWEEN, LEAVE_BINARY, LEAVE_BRACKETS };
+    struct Step
+    {
+        const Expression * expression;
+        Action action;
+    };
+
+    std::vector<Step> m_steps;
+
+    // ----------------------------------------------- Private Member Functions
+    virtual void visit(const AtomicExpression & expression) override;
+    virtual void visit(const BinaryExpression & expression) override;
+    virtual void visit(const BracketedExpression & expression) override;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // class Axiom : public Symbol                                               //
 ///////////////////////////////////////////////////////////////////////////////
@@ -400,17 +533,31 @@ public:
     // ----------------------------------------------- Constructor / Destructor
     Axiom(std::unique_ptr<const Expression> expression);
     Axiom(const Axiom & source) = delete;
-    virtual ~Axiom() = default;
+    virtual ~Axiom();
 
     // ------------------------------------------------ Public Member Functions
     virtual std::string text() const override;
     virtual double eval(const std::map<std::string, double> & values) const;
+    // values are indexed by slots()
+    virtual double eval(const double * values) const;
+    const SlotTable & slots() const;
+    inline const Expression & expression() const { return *m_expression; }
+    inline const Arena * arena() const { return m_arena.get(); }
 
     // --------------------------------------------------- Overloaded Operators
     Axiom & operator=(const Axiom & source) = delete;
+    static void * operator new(size_t size);
+    static void operator delete(void * pointer);
     
 protected:
-    const std::unique_ptr<const Expression> m_expression;
+    const std::shared_ptr<const Arena> m_arena; // Owns the nodes, if any
+    std::unique_ptr<const Expression> m_expression;
+    mutable std::once_flag m_bound;
+    mutable std::unique_ptr<const SlotTable> m_slots;
+    mutable size_t m_depth; // Nested operators and brackets, set by bind()
+
+    // --------------------------------------------- Protected Member Functions
+    void bind() const;
 };
 
 #endif // SYMBOLS_H_INCLUDED
@@ -0,0 +1,270 @@
+// --------------------------------------------------------- C++ System Headers
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "flat.h"
+#include "lexer.h"
+#include "stats.h"
+#include "symbols.h"
+#include "table.h"
+#include "trace.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Parsing Tables                                                            //
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    // ------------------------------------------------------------ Productions
+    enum Production {
+        P_AXIOM = 1,                // AXIOM -> EXP
+        P_ADD = 2,                  // EXP -> EXP + EXP
+        P_SUB = 3,                  // EXP -> EXP - EXP
+        P_MUL = 4,                  // EXP -> EXP * EXP
+        P_DIV = 5,                  // EXP -> EXP / EXP
+        P_BRACKETS = 6,             // EXP -> ( EXP )
+        P_NUM = 7,                  // EXP -> NUM
+        P_VAR = 8                   // EXP -> VAR
+    };
+
+    // Right-hand side length of each production
+    const unsigned char LENGTH[9] = { 0, 1, 3, 3, 3, 3, 3, 1, 1 };
+
+    const int STATES = 16;          // State 0 is unused, states are 1...15
+    const int TERMINALS = 9;        // Indexed by SID::Terminal
+    const int NONTERMINALS = 2;     // Indexed by SID::Nonterminal - SID::AXIOM
+    const signed char ACCEPT = 16;  // Goto on AXIOM, ends the analysis
+
+    // ACTION[state][terminal]: n > 0 shifts to state n, n < 0 reduces by
+    // production -n, 0 is a syntax error.
+    const signed char ACTION[STATES][TERMINALS] = {
+        //  $    NUM  VAR  (    )    +    -    *    /
+        {   0,   0,   0,   0,   0,   0,   0,   0,   0 },  // (unused)
+        {   0,   5,   6,   7,   0,   0,   0,   0,   0 },  // State1
+        {  -1,   0,   0,   0,   0,   3,  11,  10,  12 },  // State2
+        {   0,   5,   6,   7,   0,   0,   0,   0,   0 },  // State3
+        {  -2,  -2,  -2,  -2,  -2,  -2,  -2,  10,  12 },  // State4
+        {  -7,  -7,  -7,  -7,  -7,  -7,  -7,  -7,  -7 },  // State5
+        {  -8,  -8,  -8,  -8,  -8,  -8,  -8,  -8,  -8 },  // State6
+        {   0,   5,   6,   7,   0,   0,   0,   0,   0 },  // State7
+        {   0,   0,   0,   0,   9,   3,  11,  10,  12 },  // State8
+        {  -6,  -6,  -6,  -6,  -6,  -6,  -6,  -6,  -6 },  // State9
+        {   0,   5,   6,   7,   0,   0,   0,   0,   0 },  // State10
+        {   0,   5,   6,   7,   0,   0,   0,   0,   0 },  // State11
+        {   0,   5,   6,   7,   0,   0,   0,   0,   0 },  // State12
+        {  -5,  -5,  -5,  -5,  -5,  -5,  -5,  -5,  -5 },  // State13
+        {  -3,  -3,  -3,  -3,  -3,  -3,  -3,  10,  12 },  // State14
+        {  -4,  -4,  -4,  -4,  -4,  -4,  -4,  -4,  -4 }   // State15
+    };
+
+    // GOTO[state][nonterminal]: state reached after a reduction, 0 if none.
+    const signed char GOTO[STATES][NONTERMINALS] = {
+        //  AXIOM   EXP
+        {   0,      0 },            // (unused)
+        {   ACCEPT, 2 },            // State1
+        {   0,      0 },            // State2
+        {   0,      4 },            // State3
+        {   0,      0 },            // State4
+        {   0,      0 },            // State5
+        {   0,      0 },            // State6
+        {   0,      8 },            // State7
+        {   0,      0 },            // State8
+        {   0,      0 },            // State9
+        {   0,      15 },           // State10
+        {   0,      14 },           // State11
+        {   0,      13 },           // State12
+        {   0,      0 },            // State13
+        {   0,      0 },            // State14
+        {   0,      0 }             // State15
+    };
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class TableMachine                                                        //
+///////////////////////////////////////////////////////////////////////////////
+
+TableMachine::TableMachine(const Lexer & lexer) :
+    m_lexer(lexer)
+{}
+
+std::unique_ptr<const Axiom> TableMachine::analyze()
+{
+    TraceSpan span("analyze");
+    if(!m_arena)
+    {
+        m_arena = std::make_shared<Arena>();
+    }
+    Arena::Scope scope(m_arena);
+    LR1_STATS_TIME(PARSE);
+    m_states.push_back(1);
+    while(true)
+    {
+        const Symbol * next = m_lexer.top();
+        if(next == nullptr)
+        {
+            return std::unique_ptr<const Axiom>();
+        }
+        int action = ACTION[m_states.back()][*next];
+        if(action > 0)
+        {
+            m_states.push_back(action);
+            m_symbols.push_back(m_lexer.pop());
+            LR1_STATS_COUNT(shifts);
+            LR1_STATS_MAX(max_states, m_states.size());
+            LR1_STATS_MAX(max_symbols, m_symbols.size());
+        }
+        else if(action < 0)
+        {
+            std::unique_ptr<const Symbol> symbol = reduce(-action);
+            int state = GOTO[m_states.back()][*symbol - SID::AXIOM];
+            if(state == ACCEPT)
+            {
+                return std::unique_ptr<const Axiom>((const Axiom*) symbol.release());
+            }
+            m_states.push_back(state);
+            m_symbols.push_back(std::move(symbol));
+        }
+        else
+        {
+            error();
+            return std::unique_ptr<const Axiom>();
+        }
+    }
+}
+
+// Builds the tree into `tree`, emptied first, and returns false when the
+// expression is invalid
+bool TableMachine::analyze(FlatTree & tree)
+{
+    TraceSpan span("analyze");
+    LR1_STATS_TIME(PARSE);
+    tree.clear();
+    m_states.push_back(1);
+    m_operands.push_back(0);
+    while(true)
+    {
+        const Symbol * next = m_lexer.top();
+        if(next == nullptr)
+        {
+            return false;
+        }
+        int action = ACTION[m_states.back()][*next];
+        if(action > 0)
+        {
+            // leaves are appended when shifted, which keeps the post-order
+            size_t node = 0;
+            if(*next == SID::NUM)
+            {
+                node = tree.add_number(((const Number *) next)->value());
+            }
+            else if(*next == SID::VAR)
+            {
+                node = tree.add_variable(((const Variable *) next)->name());
+            }
+            m_states.push_back(action);
+            m_operands.push_back(node);
+            m_lexer.pop();
+            LR1_STATS_COUNT(shifts);
+            LR1_STATS_MAX(max_states, m_states.size());
+        }
+        else if(action < 0)
+        {
+            int production = -action;
+            m_states.resize(m_states.size() - LENGTH[production]);
+            LR1_STATS_COUNT(reduces[production - P_AXIOM]);
+            if(production == P_AXIOM)
+            {
+                return true;
+            }
+            size_t node = m_operands.back();
+            if(production == P_BRACKETS)
+            {
+                node = tree.add_brackets();
+            }
+            else if(production != P_NUM && production != P_VAR)
+            {
+                int kind = SID::OP_ADD + production - P_ADD;
+                node = tree.add_operator(kind, m_operands[m_operands.size() - 3]);
+            }
+            m_operands.resize(m_states.size());
+            m_states.push_back(GOTO[m_states.back()][SID::EXP - SID::AXIOM]);
+            m_operands.push_back(node);
+        }
+        else
+        {
+            error();
+            return false;
+        }
+    }
+}
+
+// Prepares the machine for another analysis, reusing its stacks and, when no
+// Axiom produced by the previous analysis is alive anymore, its arena
+void TableMachine::reset(const Lexer & lexer)
+{
+    m_symbols.clear();
+    m_states.clear();
+    m_operands.clear();
+    m_lexer = lexer;
+    if(m_arena.use_count() == 1)
+    {
+        m_arena->reset();
+    }
+    else
+    {
+        m_arena.reset();
+    }
+}
+
+std::unique_ptr<const Symbol> TableMachine::pop_symbol()
+{
+    std::unique_ptr<const Symbol> symbol = std::move(m_symbols.back());
+    m_symbols.pop_back();
+    return symbol;
+}
+
+std::unique_ptr<const Symbol> TableMachine::reduce(int production)
+{
+    m_states.resize(m_states.size() - LENGTH[production]);
+    LR1_STATS_COUNT(reduces[production - P_AXIOM]);
+    switch(production)
+    {
+        case P_AXIOM:
+        {
+            std::unique_ptr<const Expression> expr((Expression*) pop_symbol().release());
+            return std::make_unique<const Axiom>(std::move(expr));
+        }
+        case P_ADD:
+        case P_SUB:
+        case P_MUL:
+        case P_DIV:
+        {
+            std::unique_ptr<const Expression> right((Expression*) pop_symbol().release());
+            std::unique_ptr<const BinaryOperator> op((BinaryOperator*) pop_symbol().release());
+            std::unique_ptr<const Expression> left((Expression*) pop_symbol().release());
+            return std::make_unique<const BinaryExpression>(std::move(left), std::move(right), std::move(op));
+        }
+        case P_BRACKETS:
+        {
+            std::unique_ptr<const ClosedBracket> closed_bracket((ClosedBracket*) pop_symbol().release());
+            std::unique_ptr<const Expression> expr((Expression*) pop_symbol().release());
+            std::unique_ptr<const OpenBracket> open_bracket((OpenBracket*) pop_symbol().release());
+            return std::make_unique<const BracketedExpression>(std::move(expr), std::move(open_bracket), std::move(closed_bracket));
+        }
+    }
+    // P_NUM, P_VAR
+    std::unique_ptr<const AtomicValue> value((AtomicValue*) pop_symbol().release());
+    return std::make_unique<const AtomicExpression>(std::move(value));
+}
+
+void TableMachine::error()
+{
+    std::cerr << "[Error] Unexpected token '" << m_lexer.top()->text();
+    std::cerr << "' was discarded" << std::endl;
+    LR1_STATS_COUNT(errors);
+    std::cerr << "[Error] Fatal error: analysis terminated" << std::endl;
+    m_lexer.pop();
+}
@@ -0,0 +1,54 @@
+#ifndef TABLE_H_INCLUDED
+#define TABLE_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <memory>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "arena.h"
+#include "flat.h"
+#include "lexer.h"
+#include "symbols.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class TableMachine                                                        //
+///////////////////////////////////////////////////////////////////////////////
+
+// Drives the same LR(1) automaton as FiniteStateMachine (State1...State15)
+// from compact ACTION/GOTO tables: states are small integers kept on a
+// contiguous stack, no State object is allocated and no virtual call is made
+// per token.
+// analyze(FlatTree &) runs the same automaton but appends the tree to a
+// FlatTree instead: reductions only push node indices, and the tokens are
+// released as soon as they are read.
+class TableMachine
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    TableMachine(const Lexer & lexer);
+    TableMachine(const TableMachine & source) = delete;
+
+    // ------------------------------------------------ Public Member Functions
+    std::unique_ptr<const Axiom> analyze();
+    bool analyze(FlatTree & tree);
+    void reset(const Lexer & lexer);
+    inline const Arena * arena() const { return m_arena.get(); }
+
+    // --------------------------------------------------- Overloaded Operators
+    TableMachine & operator=(const TableMachine & source) = delete;
+
+private:
+    std::shared_ptr<Arena> m_arena; // Outlives the symbols carved from it
+    Lexer m_lexer;
+    std::vector<unsigned char> m_states;
+    std::vector<std::unique_ptr<const Symbol>> m_symbols;
+    std::vector<size_t> m_operands; // Nodes of a FlatTree, one per state
+
+    // ----------------------------------------------- Private Member Functions
+    std::unique_ptr<const Symbol> pop_symbol();
+    std::unique_ptr<const Symbol> reduce(int production);
+    void error();
+};
+
+#endif // TABLE_H_INCLUDED
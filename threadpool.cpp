@@ -0,0 +1,144 @@
+// --------------------------------------------------------- C++ System Headers
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// ------------------------------------------------------------ Project Headers
+#include "threadpool.h"
+
+namespace {
+
+    thread_local const ThreadPool * t_pool = nullptr;
+    thread_local size_t t_worker = ThreadPool::NO_WORKER;
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class ThreadPool                                                          //
+///////////////////////////////////////////////////////////////////////////////
+
+// Starts one worker per hardware thread when threads is 0
+ThreadPool::ThreadPool(size_t threads) :
+    m_queued(0),
+    m_pending(0),
+    m_next(0),
+    m_stop(false)
+{
+    if(threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for(size_t i=0; i<threads; ++i)
+    {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for(size_t i=0; i<threads; ++i)
+    {
+        m_workers[i]->thread = std::thread(&ThreadPool::work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for(std::unique_ptr<Worker> & worker : m_workers)
+    {
+        worker->thread.join();
+    }
+}
+
+// Tasks submitted by a worker go to its own deque, others are dealt round
+// robin
+void ThreadPool::submit(Task task)
+{
+    size_t index = worker();
+    if(index == NO_WORKER)
+    {
+        index = m_next++ % m_workers.size();
+    }
+    ++m_pending;
+    ++m_queued;
+    {
+        std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+        m_workers[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_wake.notify_one();
+}
+
+// Blocks until every submitted task is finished, must not be called from a
+// worker
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_pending == 0; });
+}
+
+// Index of the calling thread in this pool, NO_WORKER outside of it
+size_t ThreadPool::worker() const
+{
+    return t_pool == this ? t_worker : NO_WORKER;
+}
+
+void ThreadPool::work(size_t index)
+{
+    t_pool = this;
+    t_worker = index;
+    Task task;
+    while(true)
+    {
+        if(take(index, task))
+        {
+            task();
+            task = nullptr;
+            if(--m_pending == 0)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_idle.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [this] { return m_stop || m_queued > 0; });
+        if(m_stop && m_queued == 0)
+        {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::take(size_t index, Task & task)
+{
+    {
+        Worker & own = *m_workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --m_queued;
+            return true;
+        }
+    }
+    for(size_t i=1; i<m_workers.size(); ++i)
+    {
+        Worker & victim = *m_workers[(index + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --m_queued;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,65 @@
+#ifndef THREADPOOL_H_INCLUDED
+#define THREADPOOL_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// class ThreadPool                                                          //
+///////////////////////////////////////////////////////////////////////////////
+
+// Fixed set of worker threads, each owning a deque of tasks. A worker pops
+// its own most recent task first and, when its deque is empty, steals the
+// oldest task of another worker, so that uneven tasks keep every core busy.
+class ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    static const size_t NO_WORKER = (size_t) -1;
+
+    // ----------------------------------------------- Constructor / Destructor
+    ThreadPool(size_t threads = 0);
+    ThreadPool(const ThreadPool & source) = delete;
+    ~ThreadPool();
+
+    // ------------------------------------------------ Public Member Functions
+    void submit(Task task);
+    void wait();
+    size_t worker() const;
+    inline size_t size() const { return m_workers.size(); }
+
+    // --------------------------------------------------- Overloaded Operators
+    ThreadPool & operator=(const ThreadPool & source) = delete;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_queued;  // Tasks waiting in a deque
+    std::atomic<size_t> m_pending; // Tasks submitted but not finished yet
+    std::atomic<size_t> m_next;    // Deque receiving the next outside task
+    bool m_stop;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+
+    // ----------------------------------------------- Private Member Functions
+    void work(size_t index);
+    bool take(size_t index, Task & task);
+};
+
+#endif // THREADPOOL_H_INCLUDED
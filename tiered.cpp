@@ -0,0 +1,80 @@
+// --------------------------------------------------------- C++ System Headers
+#include <atomic>
+#include <memory>
+
+// ------------------------------------------------------------ Project Headers
+#include "jit.h"
+#include "program.h"
+#include "symbols.h"
+#include "tiered.h"
+#include "trace.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class TieredExecutor                                                      //
+///////////////////////////////////////////////////////////////////////////////
+
+const TieredExecutor::Thresholds TieredExecutor::DEFAULT_THRESHOLDS = { 64, 1024 };
+
+TieredExecutor::TieredExecutor(Thresholds thresholds) :
+    m_thresholds(thresholds),
+    m_compiler(1)
+{}
+
+TieredExecutor::~TieredExecutor()
+{
+    m_compiler.wait();
+}
+
+size_t TieredExecutor::add(const Axiom & axiom)
+{
+    std::unique_ptr<Entry> entry = std::make_unique<Entry>();
+    entry->axiom = &axiom;
+    entry->slots = axiom.slots();
+    entry->tier = TREE;
+    entry->evaluations = 0;
+    entry->compiling = false;
+    m_entries.push_back(std::move(entry));
+    return m_entries.size() - 1;
+}
+
+// Waits for the compilations in progress
+void TieredExecutor::wait()
+{
+    m_compiler.wait();
+}
+
+const char * TieredExecutor::tier_name(Tier tier)
+{
+    switch(tier)
+    {
+        case TREE: return "tree walker";
+        case PROGRAM: return "Program";
+        case NATIVE: return "native code";
+    }
+    return "";
+}
+
+// Compiles the tier after `tier` in the background. The new form is complete
+// before the release store of the tier publishes it to eval().
+void TieredExecutor::promote(Entry & entry, Tier tier)
+{
+    m_compiler.submit([&entry, tier] {
+        TraceSpan span("promote");
+        if(tier == TREE)
+        {
+            entry.program = std::make_unique<const Program>(*entry.axiom, entry.slots);
+            entry.tier.store(PROGRAM, std::memory_order_release);
+        }
+        else
+        {
+            entry.native = std::make_unique<const JitProgram>(*entry.program);
+            if(entry.native->function() == nullptr)
+            {
+                // no native code on this host, the Program stays
+                return;
+            }
+            entry.tier.store(NATIVE, std::memory_order_release);
+        }
+        entry.compiling.store(false, std::memory_order_release);
+    });
+}
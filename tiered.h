@@ -0,0 +1,119 @@
+#ifndef TIERED_H_INCLUDED
+#define TIERED_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "jit.h"
+#include "program.h"
+#include "slots.h"
+#include "symbols.h"
+#include "threadpool.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// class TieredExecutor                                                      //
+///////////////////////////////////////////////////////////////////////////////
+
+// Evaluates many expressions, each in the cheapest tier worth its use: every
+// expression starts in the tree walker and counts its evaluations; past the
+// program threshold it is compiled into a Program, past the native threshold
+// into a JitProgram. Compilations run on a background thread, callers keep
+// using the current tier until the next one is ready. eval() may be called
+// from any number of threads, but not concurrently with add().
+class TieredExecutor
+{
+public:
+    enum Tier {
+        TREE,                       // Axiom::eval
+        PROGRAM,                    // Program::eval
+        NATIVE                      // JitProgram, last tier
+    };
+
+    struct Thresholds
+    {
+        size_t program;             // Evaluations before compiling a Program
+        size_t native;              // Evaluations before compiling native code
+    };
+
+    static const Thresholds DEFAULT_THRESHOLDS;
+
+    // ----------------------------------------------- Constructor / Destructor
+    TieredExecutor(Thresholds thresholds = DEFAULT_THRESHOLDS);
+    TieredExecutor(const TieredExecutor & source) = delete;
+    ~TieredExecutor();
+
+    // ------------------------------------------------ Public Member Functions
+    // axiom must outlive the executor, returns the index of the expression
+    size_t add(const Axiom & axiom);
+    inline double eval(size_t expression, const double * values);
+    void wait();
+    inline const SlotTable & slots(size_t expression) const { return m_entries[expression]->slots; }
+    inline Tier tier(size_t expression) const { return m_entries[expression]->tier; }
+    inline size_t evaluations(size_t expression) const { return m_entries[expression]->evaluations; }
+    inline size_t size() const { return m_entries.size(); }
+    static const char * tier_name(Tier tier);
+
+    // --------------------------------------------------- Overloaded Operators
+    TieredExecutor & operator=(const TieredExecutor & source) = delete;
+
+private:
+    struct Entry
+    {
+        const Axiom * axiom;
+        SlotTable slots;
+        std::atomic<Tier> tier;
+        std::atomic<size_t> evaluations;    // Not counted in the last tier
+        std::atomic<bool> compiling;        // Also set for good without JIT
+        std::unique_ptr<const Program> program;
+        std::unique_ptr<const JitProgram> native;
+    };
+
+    Thresholds m_thresholds;
+    std::vector<std::unique_ptr<Entry>> m_entries;
+    ThreadPool m_compiler; // Destroyed first, with no compilation left
+
+    // ----------------------------------------------- Private Member Functions
+    void promote(Entry & entry, Tier tier);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline Member Functions                                                   //
+///////////////////////////////////////////////////////////////////////////////
+
+// values are indexed by the slots of the expression
+inline double TieredExecutor::eval(size_t expression, const double * values)
+{
+    Entry & entry = *m_entries[expression];
+    Tier tier = entry.tier.load(std::memory_order_acquire);
+    if(tier == NATIVE)
+    {
+        return entry.native->eval(values);
+    }
+    size_t evaluations = entry.evaluations.fetch_add(1, std::memory_order_relaxed) + 1;
+    if(evaluations >= (tier == TREE ? m_thresholds.program : m_thresholds.native)
+            && !entry.compiling.load(std::memory_order_relaxed)
+            && !entry.compiling.exchange(true, std::memory_order_acquire))
+    {
+        // the tier read above may predate a compilation that has finished
+        // since: each tier is only promoted from once
+        if(entry.tier.load(std::memory_order_acquire) == tier)
+        {
+            promote(entry, tier);
+        }
+        else
+        {
+            entry.compiling.store(false, std::memory_order_release);
+        }
+    }
+    if(tier == PROGRAM)
+    {
+        return entry.program->eval(values);
+    }
+    return entry.axiom->eval(values);
+}
+
+#endif // TIERED_H_INCLUDED
@@ -0,0 +1,142 @@
+// --------------------------------------------------------- C++ System Headers
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// ------------------------------------------------------------ Project Headers
+#include "trace.h"
+
+namespace {
+
+    const size_t RING_SIZE = 1 << 16; // Spans kept per thread
+
+    struct Span
+    {
+        const char * name;
+        std::chrono::steady_clock::time_point begin;
+        std::chrono::steady_clock::time_point end;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // struct Ring                                                           //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Spans of one thread, only written by that thread. head counts every
+    // span recorded so far, the last RING_SIZE of them are kept.
+    struct Ring
+    {
+        Ring(size_t thread) :
+            thread(thread),
+            head(0),
+            spans(RING_SIZE)
+        {}
+
+        size_t thread;
+        std::atomic<size_t> head;
+        std::vector<Span> spans;
+    };
+
+    std::atomic<bool> g_enabled(false);
+    std::chrono::steady_clock::time_point g_epoch;
+
+    // rings outlive their threads, the trace is written at exit
+    std::mutex g_rings_mutex;
+    std::vector<std::shared_ptr<Ring>> g_rings;
+
+    thread_local std::shared_ptr<Ring> t_ring;
+
+    Ring & ring()
+    {
+        if(!t_ring)
+        {
+            std::lock_guard<std::mutex> lock(g_rings_mutex);
+            t_ring = std::make_shared<Ring>(g_rings.size() + 1);
+            g_rings.push_back(t_ring);
+        }
+        return *t_ring;
+    }
+
+    // Microseconds since enable(), with a nanosecond resolution
+    void write_time(std::ostream & output, std::chrono::steady_clock::duration duration)
+    {
+        char buffer[32];
+        long long nanoseconds = (long long) std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        std::snprintf(buffer, sizeof(buffer), "%lld.%03lld", nanoseconds / 1000, nanoseconds % 1000);
+        output << buffer;
+    }
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class Tracer                                                              //
+///////////////////////////////////////////////////////////////////////////////
+
+void Tracer::enable()
+{
+    g_epoch = std::chrono::steady_clock::now();
+    g_enabled.store(true, std::memory_order_release);
+}
+
+bool Tracer::enabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void Tracer::record(
+        const char * name,
+        std::chrono::steady_clock::time_point begin,
+        std::chrono::steady_clock::time_point end)
+{
+    Ring & thread_ring = ring();
+    size_t head = thread_ring.head.load(std::memory_order_relaxed);
+    thread_ring.spans[head % RING_SIZE] = Span{name, begin, end};
+    thread_ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::write(std::ostream & output)
+{
+    std::lock_guard<std::mutex> lock(g_rings_mutex);
+    output << "{\"traceEvents\":[";
+    bool first = true;
+    for(const std::shared_ptr<Ring> & thread_ring : g_rings)
+    {
+        size_t head = thread_ring->head.load(std::memory_order_acquire);
+        for(size_t i=head < RING_SIZE ? 0 : head - RING_SIZE; i<head; ++i)
+        {
+            const Span & span = thread_ring->spans[i % RING_SIZE];
+            output << (first ? "\n" : ",\n") << "{\"name\":\"" << span.name << "\",\"ph\":\"X\",\"ts\":";
+            write_time(output, span.begin - g_epoch);
+            output << ",\"dur\":";
+            write_time(output, span.end - span.begin);
+            output << ",\"pid\":1,\"tid\":" << thread_ring->thread << "}";
+            first = false;
+        }
+    }
+    output << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class TraceSpan                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+TraceSpan::TraceSpan(const char * name) :
+    m_name(Tracer::enabled() ? name : nullptr)
+{
+    if(m_name != nullptr)
+    {
+        m_begin = std::chrono::steady_clock::now();
+    }
+}
+
+TraceSpan::~TraceSpan()
+{
+    if(m_name != nullptr)
+    {
+        Tracer::record(m_name, m_begin, std::chrono::steady_clock::now());
+    }
+}
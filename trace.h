@@ -0,0 +1,53 @@
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+// --------------------------------------------------------- C++ System Headers
+#include <chrono>
+#include <ostream>
+
+///////////////////////////////////////////////////////////////////////////////
+// class Tracer                                                              //
+///////////////////////////////////////////////////////////////////////////////
+
+// Records timed spans in the Chrome trace event format. Each thread appends
+// its spans to its own ring buffer, without locking: once a buffer is full the
+// oldest spans are overwritten. Nothing is recorded until enable() is called.
+class Tracer
+{
+public:
+    // ------------------------------------------------ Public Member Functions
+    static void enable();
+    static bool enabled();
+    static void record(
+            const char * name,
+            std::chrono::steady_clock::time_point begin,
+            std::chrono::steady_clock::time_point end);
+
+    // Writes the spans of every thread as a JSON trace, meant to be called
+    // once the traced threads are done
+    static void write(std::ostream & output);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class TraceSpan                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Records its lifetime as a span of the calling thread, name must outlive the
+// Tracer (a string literal)
+class TraceSpan
+{
+public:
+    // ----------------------------------------------- Constructor / Destructor
+    TraceSpan(const char * name);
+    TraceSpan(const TraceSpan & source) = delete;
+    ~TraceSpan();
+
+    // --------------------------------------------------- Overloaded Operators
+    TraceSpan & operator=(const TraceSpan & source) = delete;
+
+private:
+    const char * m_name; // Null when tracing is disabled
+    std::chrono::steady_clock::time_point m_begin;
+};
+
+#endif // TRACE_H_INCLUDED